@@ -9,6 +9,7 @@
 
 #include "dlsc_tlm_target_nb.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_apb_tlm_master_template : public sc_core::sc_module {
@@ -47,6 +48,7 @@ private:
     std::deque<burst_state>     bt_queue;
 
     int                         sel_pct;
+    dlsc_random_stream          rng;
 
     void clk_method();
 };
@@ -67,7 +69,8 @@ dlsc_apb_tlm_master_template<DATATYPE,ADDRTYPE>::dlsc_apb_tlm_master_template(
     apb_ready("apb_ready"),
     apb_rdata("apb_rdata"),
     apb_slverr("apb_slverr"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     target = new dlsc_tlm_target_nb<dlsc_apb_tlm_master_template,DATATYPE>(
         "target", this, &dlsc_apb_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback);
@@ -104,6 +107,8 @@ void dlsc_apb_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback(transactio
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_apb_tlm_master_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         apb_addr        = 0;
         apb_sel         = 0;
@@ -155,7 +160,7 @@ void dlsc_apb_tlm_master_template<DATATYPE,ADDRTYPE>::clk_method() {
             }
         }
 
-        if( (!apb_sel || (apb_enable && apb_ready)) && !bt_queue.empty() && (rand()%100) < sel_pct) {
+        if( (!apb_sel || (apb_enable && apb_ready)) && !bt_queue.empty() && (int)rng.below(100) < sel_pct) {
             // can start new transaction
             burst_state &bt = bt_queue.front();
             assert(!bt.addr.empty());
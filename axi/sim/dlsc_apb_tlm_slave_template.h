@@ -9,6 +9,7 @@
 
 #include "dlsc_tlm_initiator_nb.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_apb_tlm_slave_template : public sc_core::sc_module {
@@ -39,6 +40,7 @@ private:
 
     // configuration
     int                         ready_pct;
+    dlsc_random_stream          rng;
 
     transaction                 ts;
 
@@ -61,7 +63,8 @@ dlsc_apb_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_apb_tlm_slave_template(
     apb_ready("apb_ready"),
     apb_rdata("apb_rdata"),
     apb_slverr("apb_slverr"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     initiator = new dlsc_tlm_initiator_nb<DATATYPE>("initiator",1);
         initiator->socket.bind(socket);
@@ -75,6 +78,8 @@ dlsc_apb_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_apb_tlm_slave_template(
     
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_apb_tlm_slave_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         apb_ready   = 0;
         apb_rdata   = 0;
@@ -105,7 +110,7 @@ void dlsc_apb_tlm_slave_template<DATATYPE,ADDRTYPE>::clk_method() {
                 dlsc_error("must have 1 cycle between asertion of sel and enable");
             }
 
-            if(ts && ts->nb_done() && (rand()%100) < ready_pct) {
+            if(ts && ts->nb_done() && (int)rng.below(100) < ready_pct) {
                 apb_ready   = 1;
                 apb_slverr  = (ts->b_status() != tlm::TLM_OK_RESPONSE);
                 if(ts->is_read()) {
@@ -11,6 +11,7 @@
 #include "dlsc_tlm_target_nb.h"
 #include "dlsc_axi_types.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_axi4lb_tlm_master_template : public sc_core::sc_module {
@@ -70,6 +71,7 @@ private:
     int                         aw_pct;
     int                         w_pct;
     int                         b_pct;
+    dlsc_random_stream          rng;
 
     std::deque<transaction>                     ar_queue;
     std::map<uint32_t,std::deque<transaction> > r_queue;
@@ -127,7 +129,8 @@ dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::dlsc_axi4lb_tlm_master_templ
     axi_b_valid("axi_b_valid"),
     axi_b_id("axi_b_id"),
     axi_b_resp("axi_b_resp"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     target = new dlsc_tlm_target_nb<dlsc_axi4lb_tlm_master_template,DATATYPE>(
         "target", this, &dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback, 256);
@@ -157,6 +160,8 @@ void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback(transac
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         rst_method();
     } else {
@@ -223,7 +228,7 @@ void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::rst_method() {
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::ar_method() {
     if(!axi_ar_valid || axi_ar_ready) {
-        if(!ar_queue.empty() && (rand()%100) < ar_pct) {
+        if(!ar_queue.empty() && (int)rng.below(100) < ar_pct) {
             transaction ts  = ar_queue.front(); ar_queue.pop_front();
             axi_ar_id       = ts->get_socket_id();
             axi_ar_addr     = ts->get_address();
@@ -269,13 +274,13 @@ void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::r_method() {
         }
     }
 
-    axi_r_ready     = (rand()%100) < r_pct;
+    axi_r_ready     = (int)rng.below(100) < r_pct;
 }
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::aw_method() {
     if(!axi_aw_valid || axi_aw_ready) {
-        if(!aw_queue.empty() && (rand()%100) < aw_pct) {
+        if(!aw_queue.empty() && (int)rng.below(100) < aw_pct) {
             transaction ts  = aw_queue.front(); aw_queue.pop_front();
             axi_aw_id       = ts->get_socket_id();
             axi_aw_addr     = ts->get_address();
@@ -302,7 +307,7 @@ void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::w_method() {
             b_queue[ts->get_socket_id()].push_back(ts);
         }
 
-        if(!w_data_queue.empty() && (rand()%100) < w_pct) {
+        if(!w_data_queue.empty() && (int)rng.below(100) < w_pct) {
             axi_w_data      = w_data_queue.front(); w_data_queue.pop_front();
             axi_w_strb      = w_strb_queue.front(); w_strb_queue.pop_front();
             axi_w_last      = w_data_queue.empty();
@@ -337,7 +342,7 @@ void dlsc_axi4lb_tlm_master_template<DATATYPE,ADDRTYPE>::b_method() {
         }
     }
     
-    axi_b_ready     = (rand()%100) < b_pct;
+    axi_b_ready     = (int)rng.below(100) < b_pct;
 }
 
 
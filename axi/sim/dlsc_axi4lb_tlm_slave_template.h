@@ -12,6 +12,7 @@
 #include "dlsc_tlm_initiator_nb.h"
 #include "dlsc_axi_types.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_axi4lb_tlm_slave_template : public sc_core::sc_module {
@@ -70,6 +71,7 @@ private:
     int                         aw_pct;
     int                         w_pct;
     int                         b_pct;
+    dlsc_random_stream          rng;
 
     std::map<uint32_t,std::deque<transaction> > ar_queue;
 
@@ -126,7 +128,8 @@ dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_axi4lb_tlm_slave_templat
     axi_b_valid("axi_b_valid"),
     axi_b_id("axi_b_id"),
     axi_b_resp("axi_b_resp"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     initiator = new dlsc_tlm_initiator_nb<DATATYPE>("initiator",256);
         initiator->socket.bind(socket);
@@ -145,6 +148,8 @@ dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_axi4lb_tlm_slave_templat
     
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         rst_method();
     } else {
@@ -203,16 +208,16 @@ void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::ar_method() {
         }
     }
 
-    axi_ar_ready    = (rand()%100) < ar_pct;
+    axi_ar_ready    = (int)rng.below(100) < ar_pct;
 }
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::r_method() {
     if(!axi_r_valid || axi_r_ready) {
-        if(!r_queue.empty() && (rand()%100) < r_pct) {
+        if(!r_queue.empty() && (int)rng.below(100) < r_pct) {
             // select a random ID
             typename std::map<uint32_t,std::deque<r_type> >::iterator it = r_queue.begin();
-            std::advance(it,(rand()%r_queue.size()));
+            std::advance(it,rng.below(r_queue.size()));
             assert(!it->second.empty());
 
             r_type &rt = it->second.front();
@@ -249,7 +254,7 @@ void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::aw_method() {
         aw_queue.push_back(cmd);
     }
 
-    axi_aw_ready    = (rand()%100) < aw_pct;
+    axi_aw_ready    = (int)rng.below(100) < aw_pct;
 }
 
 template <typename DATATYPE, typename ADDRTYPE>
@@ -288,7 +293,7 @@ void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::w_method() {
     if(w_wait_aw) {
         axi_w_ready     = 0;
     } else {
-        axi_w_ready     = (rand()%100) < w_pct;
+        axi_w_ready     = (int)rng.below(100) < w_pct;
     }
     
     typename std::map<uint32_t,std::deque<transaction> >::iterator it = bts_queue.begin();
@@ -309,10 +314,10 @@ void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::w_method() {
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_axi4lb_tlm_slave_template<DATATYPE,ADDRTYPE>::b_method() {
     if(!axi_b_valid || axi_b_ready) {
-        if(!b_queue.empty() && (rand()%100) < b_pct) {
+        if(!b_queue.empty() && (int)rng.below(100) < b_pct) {
             // select a random ID
             typename std::map<uint32_t,std::deque<uint32_t> >::iterator it = b_queue.begin();
-            std::advance(it,(rand()%b_queue.size()));
+            std::advance(it,rng.below(b_queue.size()));
             assert(!it->second.empty());
 
             axi_b_id        = it->first;
@@ -32,38 +32,46 @@
 #include <iostream>
 #include <iomanip>
 
+#include "dlsc_log.h"
+#include "dlsc_prof.h"
+
 // globals defined in dlsc_main.cpp
 extern int _dlsc_chk_cnt;
 extern int _dlsc_warn_cnt;
 extern int _dlsc_err_cnt;
 
-#define dlsc_display(msg) do { std::cout << std::setw(15) << std::setfill(' ') << sc_core::sc_time_stamp() << " : [" << this->name() << ":" << __func__ << "] : " << std::dec << msg << std::endl; } while(0)
+// functions defined in dlsc_main.cpp
+void dlsc_trace_on();       // open trace file (for DLSC_TRACE_DEFER)
+void dlsc_trace_off();      // close trace file (can't be reopened)
+void dlsc_first_error();    // invoked by the first dlsc_error
+
+#define dlsc_display(msg) dlsc_log_msg(DLSC_LOG_DISPLAY,msg)
 
 #ifdef DLSC_DEBUG_WARN
-# define dlsc_warn(msg) do { _dlsc_warn_cnt++; dlsc_display("WARNING : " << msg); } while(0)
+# define dlsc_warn(msg) do { dlsc_log_count(_dlsc_warn_cnt); dlsc_log_msg(DLSC_LOG_WARN,msg); } while(0)
 #else
-# define dlsc_warn(msg) do { _dlsc_warn_cnt++; } while(0)
+# define dlsc_warn(msg) do { dlsc_log_count(_dlsc_warn_cnt); } while(0)
 #endif
 
 #ifdef DLSC_DEBUG_INFO
-# define dlsc_info(msg) do { dlsc_display("INFO : " << msg); } while(0)
+# define dlsc_info(msg) dlsc_log_msg(DLSC_LOG_INFO,msg)
 #else
 # define dlsc_info(msg) do { } while(0)
 #endif
 
 #ifdef DLSC_DEBUG_VERB
-# define dlsc_verb(msg) do { dlsc_display("VERB : " << msg); } while(0)
+# define dlsc_verb(msg) dlsc_log_msg(DLSC_LOG_VERB,msg)
 #else
 # define dlsc_verb(msg) do { } while(0)
 #endif
 
 #ifdef DLSC_DEBUG_OKAY
-# define dlsc_okay(msg) do { _dlsc_chk_cnt++; dlsc_display("OKAY : " << msg); } while(0)
+# define dlsc_okay(msg) do { dlsc_log_count(_dlsc_chk_cnt); dlsc_log_msg(DLSC_LOG_OKAY,msg); } while(0)
 #else
-# define dlsc_okay(msg) do { _dlsc_chk_cnt++; } while(0)
+# define dlsc_okay(msg) do { dlsc_log_count(_dlsc_chk_cnt); } while(0)
 #endif
 
-#define dlsc_error(msg) do { _dlsc_chk_cnt++; _dlsc_err_cnt++; dlsc_display("*** ERROR *** : " << msg); } while(0)
+#define dlsc_error(msg) do { dlsc_log_count(_dlsc_chk_cnt); dlsc_log_msg(DLSC_LOG_ERROR,msg); if(dlsc_log_count(_dlsc_err_cnt) == 1) dlsc_first_error(); } while(0)
 
 #define dlsc_assert(cond) do { if((cond)) { dlsc_okay("dlsc_assert('" << #cond << "') passed"); } else { dlsc_error("dlsc_assert('" << #cond << "') failed!"); } } while(0)
 
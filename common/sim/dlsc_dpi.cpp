@@ -30,10 +30,13 @@
 #include "systemperl.h"
 #include "svdpi.h"
 
+#include "dlsc_log.h"
+
 // globals defined in dlsc_main.cpp
 extern int _dlsc_chk_cnt;
 extern int _dlsc_warn_cnt;
 extern int _dlsc_err_cnt;
+extern void dlsc_first_error();
 
 // DPI
 extern "C" {
@@ -45,46 +48,45 @@ extern "C" {
     extern void dlsc_dpi_assert(const bool cond, const char *str);
 }
 
-void dlsc_dpi_display(const char *str, const char *severity) {
+void dlsc_dpi_display(const char *str, const int kind) {
     svScope scope = svGetScope();
     const char *scopename = svGetNameFromScope(scope);
 
-    std::cout << std::setw(15) << std::setfill(' ')
-        << sc_core::sc_time_stamp()
-        << " : [" << scopename << "] : "
-        << severity << " : "
-        << std::dec << str << std::endl;
+    if(dlsc_log_enabled(kind,scopename)) {
+        dlsc_log_begin() << str;
+        dlsc_log_end(kind,scopename,NULL);
+    }
 }
 
 void dlsc_dpi_error(const char *str) {
-    ++_dlsc_chk_cnt;
-    ++_dlsc_err_cnt;
-    dlsc_dpi_display(str,"*** ERROR ***");
+    dlsc_log_count(_dlsc_chk_cnt);
+    dlsc_dpi_display(str,DLSC_LOG_ERROR);
+    if(dlsc_log_count(_dlsc_err_cnt) == 1) dlsc_first_error();
 }
 
 void dlsc_dpi_warn(const char *str) {
-    ++_dlsc_warn_cnt;
+    dlsc_log_count(_dlsc_warn_cnt);
 #ifdef DLSC_DEBUG_WARN
-    dlsc_dpi_display(str,"WARNING");
+    dlsc_dpi_display(str,DLSC_LOG_WARN);
 #endif
 }
 
 void dlsc_dpi_info(const char *str) {
 #ifdef DLSC_DEBUG_INFO
-    dlsc_dpi_display(str,"INFO");
+    dlsc_dpi_display(str,DLSC_LOG_INFO);
 #endif
 }
 
 void dlsc_dpi_verb(const char *str) {
 #ifdef DLSC_DEBUG_VERB
-    dlsc_dpi_display(str,"VERB");
+    dlsc_dpi_display(str,DLSC_LOG_VERB);
 #endif
 }
 
 void dlsc_dpi_okay(const char *str) {
-    ++_dlsc_chk_cnt;
+    dlsc_log_count(_dlsc_chk_cnt);
 #ifdef DLSC_DEBUG_OKAY
-    dlsc_dpi_display(str,"OKAY");
+    dlsc_dpi_display(str,DLSC_LOG_OKAY);
 #endif
 }
 
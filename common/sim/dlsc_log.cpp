@@ -0,0 +1,230 @@
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <stdint.h>
+#include <systemc>
+
+#include "dlsc_log.h"
+
+int _dlsc_log_max       = DLSC_LOG_LEVEL_OKAY;
+int _dlsc_log_modules   = 0;
+
+namespace {
+
+struct log_entry {
+    sc_core::sc_time    time;
+    const char          *func;      // string literal (__func__); may be NULL
+    uint32_t            name;       // index into names
+    uint32_t            offset;     // message, in text
+    uint32_t            length;
+    int                 kind;
+};
+
+// rendered once the text reaches this size
+const size_t max_text = 16<<20;
+
+volatile int                        lock_flag = 0;
+bool                                buffered = true;
+bool                                registered = false;
+int                                 global_level = DLSC_LOG_LEVEL_OKAY;
+
+std::vector<log_entry>              entries;
+std::string                         text;
+std::vector<std::string>            names;          // interned module names
+std::map<const char*,uint32_t>      name_index;     // by (stable) name pointer
+
+std::map<std::string,int>           module_levels;  // by name prefix
+std::map<const char*,int>           level_cache;    // by (stable) name pointer
+
+__thread std::ostringstream         *thread_os = NULL;
+
+class scoped_lock {
+public:
+    scoped_lock() { while(__sync_lock_test_and_set(&lock_flag,1)) { } }
+    ~scoped_lock() { __sync_lock_release(&lock_flag); }
+};
+
+const char *prefix(const int kind) {
+    static const char *prefixes[] = {
+        "*** ERROR *** : ", "WARNING : ", "", "INFO : ", "VERB : ", "OKAY : " };
+    return prefixes[kind];
+}
+
+void render(const log_entry &e) {
+    std::cout << std::setw(15) << std::setfill(' ') << e.time << " : [" << names[e.name];
+    if(e.func) std::cout << ":" << e.func;
+    std::cout << "] : " << prefix(e.kind);
+    std::cout.write(text.data()+e.offset,e.length);
+    std::cout << std::endl;
+}
+
+// caller holds the lock
+void render_all() {
+    for(std::vector<log_entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        render(*it);
+    }
+    entries.clear();
+    text.clear();
+}
+
+void flush_at_exit() {
+    dlsc_log_flush();
+}
+
+// crashes (failed assert(), segfaults..) shouldn't lose what led up to them
+const int crash_signals[] = { SIGABRT, SIGSEGV, SIGBUS, SIGFPE, SIGILL };
+const int num_crash_signals = sizeof(crash_signals)/sizeof(crash_signals[0]);
+struct sigaction                    crash_old_actions[num_crash_signals];
+
+void flush_on_signal(int sig) {
+    // no lock; the crashing thread may be holding it
+    render_all();
+    std::cout.flush();
+    for(int i=0;i<num_crash_signals;++i) {
+        if(crash_signals[i] == sig) sigaction(sig,&crash_old_actions[i],NULL);
+    }
+    raise(sig);
+}
+
+// SystemC reports (including fatal ones) come after the messages before them
+void flush_on_report(const sc_core::sc_report &rep, const sc_core::sc_actions &actions) {
+    dlsc_log_flush();
+    sc_core::sc_report_handler::default_handler(rep,actions);
+}
+
+// caller holds the lock
+void register_flush() {
+    registered = true;
+    atexit(flush_at_exit);
+
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = flush_on_signal;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    for(int i=0;i<num_crash_signals;++i) {
+        sigaction(crash_signals[i],&sa,&crash_old_actions[i]);
+    }
+
+    sc_core::sc_report_handler::set_handler(flush_on_report);
+}
+
+uint32_t intern(const char *name) {
+    std::map<const char*,uint32_t>::iterator it = name_index.find(name);
+    if(it != name_index.end()) return it->second;
+    uint32_t i = names.size();
+    names.push_back(name);
+    name_index[name] = i;
+    return i;
+}
+
+int parse_level(const char *level) {
+    static const char *levels[] = { "error", "warn", "info", "verb", "okay" };
+    for(int i=0;i<5;++i) {
+        if(!strcmp(level,levels[i])) return i;
+    }
+    if(level[0] >= '0' && level[0] <= '4' && level[1] == '\0') return level[0]-'0';
+    return -1;
+}
+
+} // end anonymous namespace
+
+int dlsc_log_module_level(const char *name) {
+    scoped_lock lock;
+
+    std::map<const char*,int>::iterator it = level_cache.find(name);
+    if(it != level_cache.end()) return it->second;
+
+    // longest matching prefix
+    int level = global_level;
+    size_t best = 0;
+    for(std::map<std::string,int>::const_iterator mit = module_levels.begin(); mit != module_levels.end(); ++mit) {
+        if(mit->first.size() >= best && !strncmp(name,mit->first.c_str(),mit->first.size())) {
+            best    = mit->first.size();
+            level   = mit->second;
+        }
+    }
+
+    level_cache[name] = level;
+    return level;
+}
+
+std::ostream &dlsc_log_begin() {
+    if(!thread_os) thread_os = new std::ostringstream;
+    thread_os->str("");
+    thread_os->clear();
+    return *thread_os;
+}
+
+void dlsc_log_end(const int kind, const char *name, const char *func) {
+    const std::string msg = thread_os->str();
+
+    scoped_lock lock;
+
+    if(!registered) {
+        register_flush();
+    }
+
+    log_entry e;
+    e.time      = sc_core::sc_time_stamp();
+    e.func      = func;
+    e.name      = intern(name);
+    e.offset    = text.size();
+    e.length    = msg.size();
+    e.kind      = kind;
+
+    text.append(msg);
+    entries.push_back(e);
+
+    // errors are rendered right away (along with everything leading up to them)
+    if(!buffered || kind == DLSC_LOG_ERROR || text.size() >= max_text) {
+        render_all();
+    }
+}
+
+bool dlsc_log_set_level(const char *prefix, const char *level) {
+    int l = parse_level(level);
+    if(l < 0) return false;
+
+    scoped_lock lock;
+
+    if(!prefix || !prefix[0]) {
+        global_level = l;
+    } else {
+        module_levels[prefix] = l;
+    }
+
+    _dlsc_log_modules = module_levels.empty() ? 0 : 1;
+    _dlsc_log_max = global_level;
+    for(std::map<std::string,int>::const_iterator it = module_levels.begin(); it != module_levels.end(); ++it) {
+        if(it->second > _dlsc_log_max) _dlsc_log_max = it->second;
+    }
+    level_cache.clear();
+    return true;
+}
+
+bool dlsc_log_set_level(const char *spec) {
+    const char *eq = strchr(spec,'=');
+    if(!eq) return dlsc_log_set_level("",spec);
+    return dlsc_log_set_level(std::string(spec,eq-spec).c_str(),eq+1);
+}
+
+void dlsc_log_set_buffered(const bool b) {
+    scoped_lock lock;
+    buffered = b;
+    if(!buffered) render_all();
+}
+
+void dlsc_log_flush() {
+    scoped_lock lock;
+    render_all();
+    std::cout.flush();
+}
+
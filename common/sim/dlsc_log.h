@@ -0,0 +1,86 @@
+
+#ifndef DLSC_LOG_H_INCLUDED
+#define DLSC_LOG_H_INCLUDED
+
+#include <ostream>
+
+// logging backend behind dlsc_display/dlsc_error/dlsc_warn/dlsc_info/dlsc_verb/dlsc_okay
+//
+// Messages are filtered at runtime by severity, globally or per module (by
+// hierarchical name prefix); see dlsc_log_set_level. Messages that pass are
+// formatted into a reused stream and appended to an in-memory log, along
+// with their (unformatted) timestamp and source; that log is rendered to
+// std::cout when an error is logged, when it grows large, before any SystemC
+// report, and at exit or on a crash (SIGABRT, SIGSEGV..); see dlsc_log_flush.
+// dlsc_log_set_buffered(false) renders every message immediately instead.
+//
+// The appends and the assertion counters are safe to use from multiple threads.
+
+enum dlsc_log_kind {
+    DLSC_LOG_ERROR      = 0,
+    DLSC_LOG_WARN       = 1,
+    DLSC_LOG_DISPLAY    = 2,    // unconditional output; never filtered
+    DLSC_LOG_INFO       = 3,
+    DLSC_LOG_VERB       = 4,
+    DLSC_LOG_OKAY       = 5
+};
+
+// severity levels (for filtering)
+enum dlsc_log_level {
+    DLSC_LOG_LEVEL_ERROR    = 0,
+    DLSC_LOG_LEVEL_WARN     = 1,
+    DLSC_LOG_LEVEL_INFO     = 2,
+    DLSC_LOG_LEVEL_VERB     = 3,
+    DLSC_LOG_LEVEL_OKAY     = 4
+};
+
+// globals defined in dlsc_log.cpp
+extern int _dlsc_log_max;       // highest level enabled anywhere
+extern int _dlsc_log_modules;   // non-zero if any per-module levels are set
+
+inline int dlsc_log_kind_level(const int kind) {
+    static const int levels[] = {
+        DLSC_LOG_LEVEL_ERROR, DLSC_LOG_LEVEL_WARN, DLSC_LOG_LEVEL_ERROR,
+        DLSC_LOG_LEVEL_INFO, DLSC_LOG_LEVEL_VERB, DLSC_LOG_LEVEL_OKAY };
+    return levels[kind];
+}
+
+// level in effect for the named module
+int dlsc_log_module_level(const char *name);
+
+inline bool dlsc_log_enabled(const int kind, const char *name) {
+    const int level = dlsc_log_kind_level(kind);
+    if(level > _dlsc_log_max) return false;
+    if(!_dlsc_log_modules) return true;
+    return level <= dlsc_log_module_level(name);
+}
+
+// stream to format a message into (per-thread; already cleared)
+std::ostream &dlsc_log_begin();
+// appends the message formatted since dlsc_log_begin
+void dlsc_log_end(const int kind, const char *name, const char *func);
+
+// sets the level for every module whose name starts with 'prefix' (longest
+// prefix wins); an empty prefix sets the global level. 'level' is one of
+// error, warn, info, verb or okay (or 0-4). Returns false if unrecognized.
+bool dlsc_log_set_level(const char *prefix, const char *level);
+// parses "<level>" or "<module>=<level>"
+bool dlsc_log_set_level(const char *spec);
+
+void dlsc_log_set_buffered(const bool buffered);
+
+// renders everything logged so far
+void dlsc_log_flush();
+
+// atomic counter updates
+#define dlsc_log_count(cnt) __sync_add_and_fetch(&(cnt),1)
+
+#define dlsc_log_msg(kind,msg) do { \
+    if(dlsc_log_enabled((kind),this->name())) { \
+        std::ostream &_dlsc_os = dlsc_log_begin(); \
+        _dlsc_os << std::dec << msg; \
+        dlsc_log_end((kind),this->name(),__func__); \
+    } } while(0)
+
+#endif // DLSC_LOG_H_INCLUDED
+
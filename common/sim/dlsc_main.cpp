@@ -31,10 +31,18 @@
 
 #ifndef DLSC_NOT_TRACED
 #include "SpTraceVcd.h"
+#include "dlsc_trace.h"
 #endif
 
 #include <vector>
 #include <string>
+#include <sstream>
+#include <map>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include "dlsc_common.h"
 #include "dlsc_util.h"
@@ -43,18 +51,34 @@
 #include "dlsc_random.h"
 
 namespace {
+    // statically initialized, so it's valid before g_dlsc_rand_inst is constructed
+#ifdef PARAM_RAND_SEED
+    uint32_t g_dlsc_seed = PARAM_RAND_SEED;
+    uint32_t g_dlsc_base_seed = PARAM_RAND_SEED;
+#else
+    uint32_t g_dlsc_seed = 0;
+    uint32_t g_dlsc_base_seed = 0;
+#endif
     dlsc_random g_dlsc_rand_inst;
 };
 
 uint32_t dlsc_random::get_seed()
 {
-#ifdef PARAM_RAND_SEED
-    static uint32_t seed = PARAM_RAND_SEED;
-#else
-    static uint32_t seed = 0;
-#endif
-    ++seed;
-    return seed;
+    return ++g_dlsc_seed;
+}
+
+uint32_t _dlsc_random_epoch = 0;
+
+void dlsc_random::set_base_seed(uint32_t const s)
+{
+    g_dlsc_seed = s;
+    g_dlsc_base_seed = s;
+    ++_dlsc_random_epoch;
+}
+
+uint32_t dlsc_random::get_base_seed()
+{
+    return g_dlsc_base_seed;
 }
 
 
@@ -83,29 +107,427 @@ void dlsc_assert_report() {
 namespace {
 #ifndef DLSC_NOT_TRACED
     SpTraceFile *g_dlsc_tfp = NULL;
+    std::string g_dlsc_trace_path;          // what g_dlsc_tfp opens (see dlsc_trace_spawn); empty until known
+    pid_t g_dlsc_trace_pid = 0;
+    bool g_dlsc_trace_opened = false;
+    bool g_dlsc_trace_done = false;         // closed for good; can't be reopened
 #endif
     std::string g_dlsc_vcd_file;
+    double g_dlsc_trace_start = 0.0;        // ns
+    double g_dlsc_trace_stop = 0.0;         // ns; 0 to trace until the end
+    double g_dlsc_trace_ring = 0.0;         // ns; 0 to keep the whole trace
+    bool g_dlsc_profile = false;            // --profile
+    bool g_dlsc_bench = false;              // --bench
 };
 
 void dlsc_trace_on()
 {
 #ifndef DLSC_NOT_TRACED
-    if(g_dlsc_tfp && !g_dlsc_tfp->isOpen())
+    if(g_dlsc_tfp && !g_dlsc_tfp->isOpen() && !g_dlsc_trace_done && !g_dlsc_trace_path.empty())
     {
         // open trace file
-        g_dlsc_tfp->open(g_dlsc_vcd_file.c_str());
+        g_dlsc_tfp->open(g_dlsc_trace_path.c_str());
+        g_dlsc_trace_opened = true;
     }
 #endif
 }
 
-int sc_main(int argc, char **argv)
+void dlsc_trace_off()
 {
-    sp_log_file *lfp = NULL;
+#ifndef DLSC_NOT_TRACED
+    if(g_dlsc_tfp && g_dlsc_tfp->isOpen())
+    {
+        // close trace file
+        g_dlsc_tfp->close();
+    }
+    g_dlsc_trace_done = true;
+#endif
+}
+
+void dlsc_first_error()
+{
+    if(g_dlsc_trace_ring > 0.0) {
+        // flight recorder: keep the window leading up to the failure
+        dlsc_trace_off();
+    }
+}
+
+namespace {
+    // opens/closes the trace file at the --trace-start/--trace-stop times
+    class dlsc_trace_ctrl : public sc_core::sc_module {
+    public:
+        SC_HAS_PROCESS(dlsc_trace_ctrl);
+        dlsc_trace_ctrl(sc_core::sc_module_name nm) : sc_core::sc_module(nm) {
+            SC_THREAD(ctrl_thread);
+        }
+    private:
+        void ctrl_thread() {
+            if(g_dlsc_trace_start > 0.0) {
+                wait(g_dlsc_trace_start,SC_NS);
+            }
+            dlsc_trace_on();
+            if(g_dlsc_trace_stop > g_dlsc_trace_start) {
+                wait(g_dlsc_trace_stop-g_dlsc_trace_start,SC_NS);
+                dlsc_trace_off();
+            }
+        }
+    };
+};
+
+namespace {
+    std::string g_dlsc_log_file;
+    std::string g_dlsc_cov_file;
+    sp_log_file *g_dlsc_lfp = NULL;
+    double g_dlsc_checkpoint = 0.0;         // ns; 0 for no checkpoint
+
+    // applies a run's seed to everything that consumes one; generators that
+    // already exist reseed themselves on their next use
+    void dlsc_set_seed(uint32_t seed)
+    {
+        srand(seed);
+        dlsc_random::set_base_seed(seed);
+        g_dlsc_rand_inst.seed(dlsc_random::get_seed());
+    }
+
+    // inserts ".<tag><N>" ahead of the file's extension (if any)
+    std::string dlsc_tag_file(const std::string &file, const char *tag, uint32_t n)
+    {
+        if(file.empty()) return file;
+        std::ostringstream ss;
+        ss << "." << tag << n;
+        std::string::size_type dot = file.rfind('.');
+        std::string::size_type slash = file.rfind('/');
+        if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return file + ss.str();
+        }
+        return file.substr(0,dot) + ss.str() + file.substr(dot);
+    }
+
+    void dlsc_open_log(const std::string &log_file)
+    {
+        if(!log_file.empty()) {
+            g_dlsc_lfp = new sp_log_file;           // log file writer
+            g_dlsc_lfp->open(log_file.c_str());     // open log file
+            g_dlsc_lfp->redirect_cout();            // capture all output to log
+        }
+    }
+
+    // starts writing the trace (if any) to 'vcd_file'
+    void dlsc_open_trace(const std::string &vcd_file)
+    {
+#ifndef DLSC_NOT_TRACED
+        if(g_dlsc_tfp) {
+            g_dlsc_trace_path = dlsc_trace_spawn(vcd_file,g_dlsc_trace_ring,g_dlsc_trace_pid);
+        }
+#endif
+    }
+
+    // opens the log file and elaborates the testbench; with 'deferred', the
+    // trace's destination is left for dlsc_open_trace
+    void dlsc_elaborate(const bool deferred)
+    {
+#ifndef DLSC_NOT_TRACED
+        if(!g_dlsc_vcd_file.empty()) {
+#ifndef DLSC_NOT_VERILATED
+            Verilated::traceEverOn(true);           // we're going to be tracing
+#endif
+            g_dlsc_tfp = new SpTraceFile;           // trace file writer
+            if(!deferred) {
+                dlsc_open_trace(g_dlsc_vcd_file);
+            }
+        }
+#endif
+
+        dlsc_open_log(g_dlsc_log_file);
+
+        DLSC_TB *tb = new DLSC_TB("tb");        // instantiate testbench
+
+#ifndef DLSC_NOT_TRACED
+        if(g_dlsc_tfp) {
+            tb->trace(g_dlsc_tfp,99);               // trace testbench (once file is opened)
+            if(g_dlsc_trace_start > 0.0 || g_dlsc_trace_stop > 0.0) {
+                new dlsc_trace_ctrl("dlsc_trace_ctrl"); // open/close trace file at specified times
+            } else {
+#ifndef DLSC_TRACE_DEFER
+                dlsc_trace_on();                    // open trace file
+#endif
+            }
+        }
+#endif
+        (void)tb; // suppress "unused variable" warning
+    }
+
+    // writes results and closes everything dlsc_elaborate opened
+    void dlsc_finish(const std::string &cov_file)
+    {
+        dlsc_log_flush();                       // render buffered messages
+
+        dlsc_prof_report();                     // write profile (if enabled)
+        
+        if(!cov_file.empty()) {
+            SpCoverage::write(cov_file.c_str()); // write coverage results
+        }
+        
+        dlsc_assert_report();                   // write pass/fail report
+
+#ifndef DLSC_NOT_TRACED
+        if(g_dlsc_tfp && g_dlsc_tfp->isOpen()) {
+            g_dlsc_tfp->close();                    // close trace file
+        }
+        dlsc_trace_finish(g_dlsc_trace_path,g_dlsc_trace_pid,g_dlsc_trace_opened); // wait for any trace post-processing
+#endif
+        if(g_dlsc_lfp) g_dlsc_lfp->close();     // close log file
+    }
+
+    void dlsc_find_clocks(const std::vector<sc_core::sc_object*> &objs, std::vector<sc_core::sc_clock*> &clocks)
+    {
+        for(std::vector<sc_core::sc_object*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+            sc_core::sc_clock *clk = dynamic_cast<sc_core::sc_clock*>(*it);
+            if(clk) clocks.push_back(clk);
+            dlsc_find_clocks((*it)->get_child_objects(),clocks);
+        }
+    }
+
+    // reports simulation speed, in cycles of the fastest clock (and any
+    // dlsc_bench_counter rates); for 'make bench_run'
+    void dlsc_bench_report(const uint64_t wall_ns)
+    {
+        std::vector<sc_core::sc_clock*> clocks;
+        dlsc_find_clocks(sc_core::sc_get_top_level_objects(),clocks);
+
+        const double wall = wall_ns / 1e9;
+        std::cout << std::dec << std::fixed << std::setprecision(3) << "bench: ";
+        sc_core::sc_clock *fastest = NULL;
+        for(unsigned int i=0;i<clocks.size();++i) {
+            if(!fastest || clocks[i]->period() < fastest->period()) fastest = clocks[i];
+        }
+        if(fastest) {
+            const double cycles = sc_time_stamp() / fastest->period();
+            std::cout << (uint64_t)cycles << " cycles of " << fastest->name() << " in " << wall << " s ("
+                << (uint64_t)(wall > 0.0 ? cycles/wall : 0.0) << " cycles/s)";
+        } else {
+            std::cout << "(no clocks) " << wall << " s";
+        }
+        std::cout << "; " << sc_time_stamp() << " simulated" << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+
+        dlsc_bench_report_counters(wall);       // e.g. TLPs/s
+    }
+
+    // elaborates and runs one simulation
+    void dlsc_run()
+    {
+        dlsc_elaborate(false);
+
+        if(g_dlsc_profile) {
+            dlsc_prof_start();                      // start sampling processes
+        }
+
+        const uint64_t start = dlsc_prof_now();
+
+        sc_start();                             // run the simulation; will exit on sc_stop()
+
+        if(g_dlsc_bench) {
+            dlsc_bench_report(dlsc_prof_now() - start); // report simulation speed
+        }
+
+        dlsc_finish(g_dlsc_cov_file);
+    }
+
+    // one --seeds run; elaborates from scratch
+    void dlsc_seed_worker(uint32_t seed)
+    {
+        dlsc_set_seed(seed);
+        g_dlsc_vcd_file = dlsc_tag_file(g_dlsc_vcd_file,"seed",seed);
+        g_dlsc_log_file = dlsc_tag_file(g_dlsc_log_file.empty() ? "dlsc.log" : g_dlsc_log_file,"seed",seed);
+        g_dlsc_cov_file = dlsc_tag_file(g_dlsc_cov_file,"seed",seed);
+        dlsc_run();
+    }
+
+    // seed of experiment 'n'; spread out like --seeds, and distinct from the checkpointed run's
+    uint32_t dlsc_experiment_seed(uint32_t n)
+    {
+        return g_dlsc_base_seed + (n+1)*65536;
+    }
+
+    // one experiment; continues the checkpointed simulation (inherited
+    // through fork) with its own seed and output files
+    void dlsc_experiment_worker(uint32_t n)
+    {
+        const uint32_t seed = dlsc_experiment_seed(n);
+
+        if(g_dlsc_lfp) g_dlsc_lfp->close();     // checkpointed run's log
+        dlsc_open_log(dlsc_tag_file(g_dlsc_log_file.empty() ? "dlsc.log" : g_dlsc_log_file,"exp",n));
+
+        std::cout << std::dec << sc_time_stamp() << " : experiment " << n << " (seed " << seed << ") starting from checkpoint" << std::endl;
+
+        dlsc_set_seed(seed);
+
+#ifndef DLSC_NOT_TRACED
+        if(g_dlsc_tfp) {
+            dlsc_open_trace(dlsc_tag_file(g_dlsc_vcd_file,"exp",n));
+            // dlsc_trace_ctrl handles a start time that's still ahead
+            const double now = sc_time_stamp().to_seconds()*1e9;
+            if(g_dlsc_trace_start <= now && (g_dlsc_trace_stop <= 0.0 || g_dlsc_trace_stop > now)) {
+                dlsc_trace_on();
+            }
+        }
+#endif
+
+        if(g_dlsc_profile) {
+            dlsc_prof_start();                      // profile just the experiment
+        }
+
+        sc_start();
+
+        dlsc_finish(dlsc_tag_file(g_dlsc_cov_file,"exp",n));
+    }
+
+    struct dlsc_worker {
+        uint32_t    id;
+        int         fd;         // read end of the worker's result pipe
+    };
+
+    // runs 'fn' for each of 'ids', each in its own forked worker (at most 'jobs'
+    // at a time), and merges the workers' assertion counts into this process'
+    // report. 'what' names an id (and the option that reruns one).
+    void dlsc_run_workers(
+        const char                  *what,
+        const std::vector<uint32_t> &ids,
+        void                        (*fn)(uint32_t),
+        unsigned int                jobs)
+    {
+        std::map<pid_t,dlsc_worker> running;
+        std::vector<uint32_t> failed;
+        int chk_cnt = 0, warn_cnt = 0, err_cnt = 0;
+
+        std::cout << std::dec << "running " << ids.size() << " " << what << "s (" << jobs << " jobs)" << std::endl;
+
+        unsigned int next = 0;
+        while(next < ids.size() || !running.empty()) {
+            while(next < ids.size() && running.size() < jobs) {
+                uint32_t id = ids[next++];
+
+                int fds[2];
+                if(pipe(fds) != 0) {
+                    std::cerr << "dlsc_main: pipe() failed" << std::endl;
+                    exit(1);
+                }
+
+                std::cout.flush();
+                std::cerr.flush();
+                pid_t pid = fork();
+                if(pid < 0) {
+                    std::cerr << "dlsc_main: fork() failed" << std::endl;
+                    exit(1);
+                }
+
+                if(pid == 0) {
+                    // worker
+                    close(fds[0]);
+                    fn(id);
+                    int cnt[3] = { _dlsc_chk_cnt, _dlsc_warn_cnt, _dlsc_err_cnt };
+                    if(write(fds[1],cnt,sizeof(cnt)) != (ssize_t)sizeof(cnt)) {
+                        exit(1);
+                    }
+                    close(fds[1]);
+                    exit(0);
+                }
+
+                close(fds[1]);
+                dlsc_worker &w = running[pid];
+                w.id    = id;
+                w.fd    = fds[0];
+            }
+
+            int status;
+            pid_t pid = wait(&status);
+            if(pid < 0) break;
+
+            std::map<pid_t,dlsc_worker>::iterator wit = running.find(pid);
+            if(wit == running.end()) continue;
+            dlsc_worker w = wit->second;
+            running.erase(wit);
+
+            int cnt[3] = { 0, 0, 0 };
+            bool okay = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                read(w.fd,cnt,sizeof(cnt)) == (ssize_t)sizeof(cnt);
+            close(w.fd);
+
+            if(!okay) {
+                // crashed or otherwise didn't report; count it as an error
+                cnt[2]++;
+            }
+
+            chk_cnt     += cnt[0];
+            warn_cnt    += cnt[1];
+            err_cnt     += cnt[2];
+
+            bool pass = (cnt[2] == 0 && cnt[0] > 0);
+            if(!pass) failed.push_back(w.id);
+
+            std::cout << std::dec << what << " " << w.id << ": " << (pass ? "PASSED" : "FAILED");
+            if(!okay) std::cout << " (worker did not complete)";
+            std::cout << " (" << cnt[2] << " errors/" << cnt[0] << " assertions, " << cnt[1] << " warnings)" << std::endl;
+        }
+
+        if(!failed.empty()) {
+            std::cout << "failing " << what << "s (rerun with --" << what << " <N>):";
+            for(unsigned int i=0;i<failed.size();++i) {
+                std::cout << " " << failed[i];
+            }
+            std::cout << std::endl;
+        }
+
+        _dlsc_chk_cnt   = chk_cnt;
+        _dlsc_warn_cnt  = warn_cnt;
+        _dlsc_err_cnt   = err_cnt;
+
+        dlsc_assert_report();                   // write merged pass/fail report
+    }
+
+    // runs until the checkpoint, then forks the experiments from there; each
+    // inherits the entire simulation state (SystemC processes, Verilated
+    // model, memories, queues and generators) and then diverges through its seed;
+    // not available with threaded models (see sc_main)
+    void dlsc_run_checkpoint(const std::vector<uint32_t> &experiments, unsigned int jobs)
+    {
+        dlsc_elaborate(true);
+
+        sc_start(g_dlsc_checkpoint,SC_NS);      // warm up
+
+        dlsc_log_flush();                       // children shouldn't repeat anything
+
+        if(sc_time_stamp() < sc_time(g_dlsc_checkpoint,SC_NS)) {
+            std::cout << std::dec << sc_time_stamp() << " : simulation ended before the checkpoint at "
+                << sc_time(g_dlsc_checkpoint,SC_NS) << std::endl;
+            dlsc_finish(g_dlsc_cov_file);
+            return;
+        }
+
+        std::cout << std::dec << sc_time_stamp() << " : checkpoint" << std::endl;
+
+        dlsc_run_workers("experiment",experiments,dlsc_experiment_worker,jobs);
+
+        if(g_dlsc_lfp) g_dlsc_lfp->close();
+    }
+};
 
+int sc_main(int argc, char **argv)
+{
     // parse arguments
 
-    std::string log_file;
-    std::string cov_file;
+    unsigned int seeds = 0;
+    unsigned int jobs = 0;
+    unsigned int experiments = 1;
+    int experiment = -1;
+    bool seed_set = false;
+#ifdef PARAM_RAND_SEED
+    uint32_t seed = PARAM_RAND_SEED;
+#else
+    uint32_t seed = 0;
+#endif
     
     std::vector<std::string> args;
     for(int i=1;i<argc;i++) {
@@ -115,14 +537,57 @@ int sc_main(int argc, char **argv)
     std::vector<std::string>::iterator it = args.begin();
     while(it != args.end()) {
         if(*it == "--log" && ++it != args.end()) {
-            log_file = *it;
+            g_dlsc_log_file = *it;
         }
         if(*it == "--cov" && ++it != args.end()) {
-            cov_file = *it;
+            g_dlsc_cov_file = *it;
         }
         if(*it == "--vcd" && ++it != args.end()) {
             g_dlsc_vcd_file = *it;
         }
+        if(*it == "--trace-start" && ++it != args.end()) {
+            g_dlsc_trace_start = strtod(it->c_str(),NULL);
+        }
+        if(*it == "--trace-stop" && ++it != args.end()) {
+            g_dlsc_trace_stop = strtod(it->c_str(),NULL);
+        }
+        if(*it == "--trace-ring" && ++it != args.end()) {
+            g_dlsc_trace_ring = strtod(it->c_str(),NULL);
+        }
+        if(*it == "--verbosity" && ++it != args.end()) {
+            if(!dlsc_log_set_level(it->c_str())) {
+                std::cerr << "unrecognized --verbosity " << *it << std::endl;
+            }
+        }
+        if(*it == "--log-unbuffered") {
+            dlsc_log_set_buffered(false);
+        }
+        if(*it == "--profile") {
+            g_dlsc_profile = true;
+        }
+        if(*it == "--bench") {
+            g_dlsc_bench = true;
+        }
+        if(*it == "--seed" && ++it != args.end()) {
+            seed = strtoul(it->c_str(),NULL,0);
+            seed_set = true;
+        }
+        if(*it == "--seeds" && ++it != args.end()) {
+            seeds = strtoul(it->c_str(),NULL,0);
+        }
+        if(*it == "--jobs" && ++it != args.end()) {
+            jobs = strtoul(it->c_str(),NULL,0);
+        }
+        if(*it == "--checkpoint" && ++it != args.end()) {
+            g_dlsc_checkpoint = strtod(it->c_str(),NULL);
+        }
+        if(*it == "--experiments" && ++it != args.end()) {
+            experiments = strtoul(it->c_str(),NULL,0);
+        }
+        if(*it == "--experiment" && ++it != args.end()) {
+            experiment = strtol(it->c_str(),NULL,0);
+        }
+        if(it == args.end()) break;
         ++it;
     }
 
@@ -130,53 +595,72 @@ int sc_main(int argc, char **argv)
     Verilated::commandArgs(argc, argv);     // needed for $test$plusargs
 #endif
 
-#ifdef PARAM_RAND_SEED
-    // seed random number generator with supplied value
-    srand(PARAM_RAND_SEED);
-#endif
+    if(g_dlsc_trace_ring > 0.0 && g_dlsc_trace_stop > g_dlsc_trace_start + g_dlsc_trace_ring) {
+        // end of the window is known; don't trace anything the ring would drop
+        g_dlsc_trace_start = g_dlsc_trace_stop - g_dlsc_trace_ring;
+    }
 
-#ifndef DLSC_NOT_TRACED
-    if(!g_dlsc_vcd_file.empty()) {
-#ifndef DLSC_NOT_VERILATED
-        Verilated::traceEverOn(true);           // we're going to be tracing
-#endif
-        g_dlsc_tfp = new SpTraceFile;           // trace file writer
+#ifdef VL_THREADED
+    if(g_dlsc_checkpoint > 0.0) {
+        // forked children don't inherit the Verilated model's worker threads
+        std::cerr << "dlsc_main: --checkpoint isn't supported with a threaded Verilator model (VERILATOR_THREADS)" << std::endl;
+        return 1;
     }
 #endif
 
-    if(!log_file.empty()) {
-        lfp = new sp_log_file;                  // log file writer
-        lfp->open(log_file.c_str());            // open log file
-        lfp->redirect_cout();                   // capture all output to log
+    if(jobs == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (n > 0) ? n : 1;
     }
 
-    DLSC_TB *tb = new DLSC_TB("tb");        // instantiate testbench
+    if(seeds > 0 && g_dlsc_checkpoint <= 0.0) {
+        sp_log_file *lfp = NULL;
+        if(!g_dlsc_log_file.empty()) {
+            lfp = new sp_log_file;                  // merged report goes to the log file
+            lfp->open(g_dlsc_log_file.c_str());
+            lfp->redirect_cout();
+        }
 
-#ifndef DLSC_NOT_TRACED
-    if(g_dlsc_tfp) {
-        tb->trace(g_dlsc_tfp,99);               // trace testbench (once file is opened)
-#ifndef DLSC_TRACE_DEFER
-        dlsc_trace_on();                        // open trace file
-#endif
-    }
-#endif
+        // seeds are consumed during elaboration, so each worker starts from scratch;
+        // spread them out, so the per-instance seeds of different runs don't overlap
+        std::vector<uint32_t> ids;
+        for(unsigned int i=0;i<seeds;++i) {
+            ids.push_back(seed + i*65536);
+        }
+        dlsc_run_workers("seed",ids,dlsc_seed_worker,jobs);
 
-    if(tb) { // suppress "unused variable" warning
-        sc_start();                             // run the simulation; will exit on sc_stop()
+        if(lfp) lfp->close();
+        return 0;//_dlsc_err_cnt;
     }
-    
-    if(!cov_file.empty()) {
-        SpCoverage::write(cov_file.c_str()); // write coverage results
+
+    if(seed_set) {
+        // reproduces one run of a --seeds regression
+        dlsc_set_seed(seed);
+    } else {
+#ifdef PARAM_RAND_SEED
+        // seed random number generator with supplied value
+        srand(PARAM_RAND_SEED);
+#endif
     }
-    
-    dlsc_assert_report();                   // write pass/fail report
 
-#ifndef DLSC_NOT_TRACED
-    if(g_dlsc_tfp && g_dlsc_tfp->isOpen()) {
-        g_dlsc_tfp->close();                    // close trace file
+    if(g_dlsc_checkpoint > 0.0) {
+        if(seeds > 0) {
+            std::cerr << "dlsc_main: --seeds ignored with --checkpoint (use --experiments)" << std::endl;
+        }
+        std::vector<uint32_t> ids;
+        if(experiment >= 0) {
+            // reproduces one experiment
+            ids.push_back(experiment);
+        } else {
+            for(unsigned int i=0;i<experiments;++i) {
+                ids.push_back(i);
+            }
+        }
+        dlsc_run_checkpoint(ids,jobs);
+        return 0;//_dlsc_err_cnt;
     }
-#endif
-    if(lfp) lfp->close();                   // close log file
+
+    dlsc_run();
 
     return 0;//_dlsc_err_cnt;
 }
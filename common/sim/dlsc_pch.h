@@ -0,0 +1,30 @@
+
+#ifndef DLSC_PCH_H_INCLUDED
+#define DLSC_PCH_H_INCLUDED
+
+// precompiled header; the objdir makefile compiles this once per shared
+// library directory and force-includes it (-include) in every C++ compile.
+// Only large, rarely-changing third-party headers belong here; anything that
+// depends on PARAM_* defines would make the PCH unusable.
+
+#include <systemc>
+#include <tlm.h>
+
+// the TLM utilities need dynamic processes (tlm.inc.makefile defines this)
+#ifdef SC_INCLUDE_DYNAMIC_PROCESSES
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/multi_passthrough_initiator_socket.h>
+#include <tlm_utils/multi_passthrough_target_socket.h>
+#include <tlm_utils/peq_with_get.h>
+#endif
+
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+
+#endif // DLSC_PCH_H_INCLUDED
+
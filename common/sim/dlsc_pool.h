@@ -0,0 +1,130 @@
+
+#ifndef DLSC_POOL_H_INCLUDED
+#define DLSC_POOL_H_INCLUDED
+
+#include <vector>
+#include <cassert>
+#include <stdint.h>
+#include <boost/intrusive_ptr.hpp>
+
+// recycling pool for objects that a model creates at a high rate (e.g. one per
+// packet) and hands around by boost::intrusive_ptr
+//
+// Objects derive from dlsc_pooled<T> and provide reset(), which must drop
+// everything the object holds (including references to other pooled objects).
+// The pool allocates objects a slab at a time; when the last reference to
+// one is dropped, it is reset and goes back on the pool's free list. Objects
+// created with plain 'new' are reference counted the same way, but deleted.
+//
+// Pools must outlive the containers that hold their objects (declare them
+// first). A pool destroyed with objects still outstanding leaks its slabs and
+// detaches every object in them; the remaining references stay valid, and the
+// last release of each just resets it.
+
+template <typename T>
+class dlsc_pool;
+
+template <typename T>
+class dlsc_pooled {
+public:
+    dlsc_pooled() : pool_(0), slab_(false), refcnt_(0) { }
+    // copies are independent objects; never part of a pool
+    dlsc_pooled(const dlsc_pooled&) : pool_(0), slab_(false), refcnt_(0) { }
+    dlsc_pooled &operator=(const dlsc_pooled&) { return *this; }
+
+    // reference counting for boost::intrusive_ptr
+    friend inline void intrusive_ptr_add_ref(T *p) {
+        ++static_cast<dlsc_pooled*>(p)->refcnt_;
+    }
+    friend inline void intrusive_ptr_release(T *p) {
+        dlsc_pooled *b = p;
+        assert(b->refcnt_ > 0);
+        if(--b->refcnt_ == 0) b->recycle();
+    }
+
+private:
+    friend class dlsc_pool<T>;
+
+    // back to the pool once unreferenced
+    void recycle() {
+        T *p = static_cast<T*>(this);
+        if(pool_) pool_->free(p);
+        else if(slab_) p->reset();      // pool is gone; slab is leaked
+        else delete p;
+    }
+
+    dlsc_pool<T>        *pool_;
+    bool                slab_;
+    unsigned int        refcnt_;
+};
+
+template <typename T>
+class dlsc_pool {
+public:
+    typedef boost::intrusive_ptr<T> pointer;
+
+    explicit dlsc_pool(const unsigned int slab_size = 64) :
+        slab_size(slab_size), outstanding(0), high_water(0), allocs(0) { }
+
+    ~dlsc_pool() {
+        for(typename std::vector<T*>::iterator it = slabs.begin(); it != slabs.end(); ++it) {
+            if(outstanding) {
+                for(unsigned int i=0;i<slab_size;++i) {
+                    static_cast<dlsc_pooled<T>&>((*it)[i]).pool_ = 0;
+                }
+            } else {
+                delete [] *it;
+            }
+        }
+    }
+
+    pointer alloc() {
+        if(pool.empty()) grow();
+        T *p = pool.back();
+        pool.pop_back();
+        if(++outstanding > high_water) high_water = outstanding;
+        allocs++;
+        return pointer(p);
+    }
+
+    // statistics
+    inline unsigned int get_outstanding() const { return outstanding; }
+    inline unsigned int get_high_water() const { return high_water; }
+    inline unsigned int get_capacity() const { return slabs.size()*slab_size; }
+    inline uint64_t get_allocs() const { return allocs; }
+
+private:
+    friend class dlsc_pooled<T>;
+
+    // no copying/assigning
+    dlsc_pool(const dlsc_pool&);
+    dlsc_pool& operator= (const dlsc_pool&);
+
+    void grow() {
+        T *slab = new T[slab_size];
+        slabs.push_back(slab);
+        pool.reserve(pool.size() + slab_size);
+        for(int i=slab_size-1;i>=0;--i) {
+            static_cast<dlsc_pooled<T>&>(slab[i]).pool_ = this;
+            static_cast<dlsc_pooled<T>&>(slab[i]).slab_ = true;
+            pool.push_back(&slab[i]);
+        }
+    }
+
+    void free(T *p) {
+        assert(outstanding > 0);
+        p->reset();
+        pool.push_back(p);
+        outstanding--;
+    }
+
+    const unsigned int  slab_size;
+    std::vector<T*>     slabs;
+    std::vector<T*>     pool;
+    unsigned int        outstanding;
+    unsigned int        high_water;
+    uint64_t            allocs;
+};
+
+#endif // DLSC_POOL_H_INCLUDED
+
@@ -0,0 +1,269 @@
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <stdint.h>
+#include <sys/time.h>
+#include <systemc>
+
+#include "dlsc_prof.h"
+
+bool _dlsc_prof_enabled = false;
+
+struct dlsc_prof_entry {
+    uint64_t    activations;
+    uint64_t    ns;
+};
+
+namespace {
+
+const unsigned int sample_us    = 1000;
+const unsigned int sample_slots = 4096;     // power of 2
+
+// filled in by the SIGPROF handler; keyed by sc_process_b*
+struct sample_slot {
+    void                * volatile key;
+    volatile uint32_t   count;
+};
+
+sample_slot                         samples[sample_slots];
+volatile uint32_t                   sched_samples = 0;      // no process running
+volatile uint32_t                   lost_samples = 0;       // table full
+
+struct sigaction                    old_action;
+uint64_t                            start_ns = 0;
+
+std::map<void*,dlsc_prof_entry*>    entries;                // keyed by sc_process_b*
+
+// timestep tracking
+bool                                step_valid = false;
+sc_core::sc_time                    step_time;
+sc_dt::uint64                       step_delta = 0;
+uint64_t                            steps = 0;
+uint64_t                            step_deltas = 0;
+uint64_t                            step_max = 0;
+std::vector<uint64_t>               step_hist;              // log2 buckets
+
+// --bench counters
+std::vector<std::pair<std::string,const uint64_t*> > bench_counters;
+
+void on_sigprof(int) {
+    void *key = sc_core::sc_get_current_process_b();
+    if(!key) {
+        sched_samples = sched_samples + 1;
+        return;
+    }
+    uint32_t h = (uint32_t)(((uintptr_t)key >> 4) * 2654435761u);
+    for(unsigned int i=0;i<sample_slots;++i) {
+        sample_slot &s = samples[(h+i)&(sample_slots-1)];
+        if(s.key == key || !s.key) {
+            s.key   = key;
+            s.count = s.count + 1;
+            return;
+        }
+    }
+    lost_samples = lost_samples + 1;
+}
+
+void close_step(const uint64_t deltas) {
+    steps++;
+    step_deltas += deltas;
+    step_max = std::max(step_max,deltas);
+    unsigned int b = 0;
+    for(uint64_t v=deltas;v;v>>=1) ++b;
+    if(b >= step_hist.size()) step_hist.resize(b+1,0);
+    step_hist[b]++;
+}
+
+// every process in the hierarchy, by name
+void collect(const std::vector<sc_core::sc_object*> &objs, std::map<const sc_core::sc_object*,std::string> &names) {
+    for(std::vector<sc_core::sc_object*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+        if(strstr((*it)->kind(),"process")) {
+            names[*it] = (*it)->name();
+        }
+        collect((*it)->get_child_objects(),names);
+    }
+}
+
+struct prof_row {
+    std::string     name;
+    uint64_t        samples;
+    uint64_t        activations;
+    uint64_t        ns;
+    bool            instrumented;
+};
+
+bool by_cost(const prof_row &a, const prof_row &b) {
+    if(a.samples != b.samples) return a.samples > b.samples;
+    return a.ns > b.ns;
+}
+
+bool ends_with(const std::string &s, const char *suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size()-n,n,suffix) == 0;
+}
+
+} // end anonymous namespace
+
+uint64_t dlsc_prof_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+dlsc_prof_entry *dlsc_prof_enter() {
+    const sc_core::sc_time &t = sc_core::sc_time_stamp();
+    if(!step_valid || t != step_time) {
+        sc_dt::uint64 d = sc_core::sc_delta_count();
+        if(step_valid) close_step(d - step_delta);
+        step_valid  = true;
+        step_time   = t;
+        step_delta  = d;
+    }
+
+    void *key = sc_core::sc_get_current_process_b();
+    dlsc_prof_entry *&entry = entries[key];
+    if(!entry) {
+        entry = new dlsc_prof_entry;
+        entry->activations  = 0;
+        entry->ns           = 0;
+    }
+    entry->activations++;
+    return entry;
+}
+
+void dlsc_prof_leave(dlsc_prof_entry *entry, const uint64_t start) {
+    entry->ns += dlsc_prof_now() - start;
+}
+
+void dlsc_prof_start() {
+    _dlsc_prof_enabled = true;
+    start_ns = dlsc_prof_now();
+
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = on_sigprof;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF,&sa,&old_action);
+
+    struct itimerval it;
+    it.it_interval.tv_sec   = 0;
+    it.it_interval.tv_usec  = sample_us;
+    it.it_value             = it.it_interval;
+    setitimer(ITIMER_PROF,&it,NULL);
+}
+
+void dlsc_prof_report() {
+    if(!_dlsc_prof_enabled) return;
+
+    struct itimerval it;
+    memset(&it,0,sizeof(it));
+    setitimer(ITIMER_PROF,&it,NULL);
+    sigaction(SIGPROF,&old_action,NULL);
+    _dlsc_prof_enabled = false;
+
+    const double wall = (dlsc_prof_now() - start_ns) / 1e9;
+    if(step_valid) {
+        close_step(sc_core::sc_delta_count() - step_delta);
+        step_valid = false;
+    }
+
+    // processes that have already been destroyed (e.g. finished dynamic
+    // processes) can't be named; their keys are only compared, never dereferenced
+    std::map<const sc_core::sc_object*,std::string> names;
+    collect(sc_core::sc_get_top_level_objects(),names);
+
+    std::map<void*,prof_row> rows;
+    uint64_t total = sched_samples + lost_samples;
+    for(unsigned int i=0;i<sample_slots;++i) {
+        if(!samples[i].key) continue;
+        void *key = samples[i].key;
+        prof_row &r = rows[key];
+        r.samples = samples[i].count;
+        total += r.samples;
+    }
+    for(std::map<void*,dlsc_prof_entry*>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        prof_row &r = rows[it->first];
+        r.activations   = it->second->activations;
+        r.ns            = it->second->ns;
+        r.instrumented  = true;
+    }
+
+    std::vector<prof_row> ranked;
+    uint64_t eval_samples = 0;
+    for(std::map<void*,prof_row>::iterator it = rows.begin(); it != rows.end(); ++it) {
+        const sc_core::sc_object *obj = static_cast<sc_core::sc_process_b*>(it->first);
+        std::map<const sc_core::sc_object*,std::string>::const_iterator nit = names.find(obj);
+        it->second.name = (nit != names.end()) ? nit->second : "(destroyed process)";
+        // Verilator's SystemC models evaluate from an SC_METHOD named 'eval'
+        if(ends_with(it->second.name,".eval")) eval_samples += it->second.samples;
+        ranked.push_back(it->second);
+    }
+    if(sched_samples) {
+        prof_row r = prof_row();
+        r.name      = "(scheduler)";
+        r.samples   = sched_samples;
+        ranked.push_back(r);
+    }
+    std::sort(ranked.begin(),ranked.end(),by_cost);
+
+    const double pct = total ? 100.0/total : 0.0;
+
+    std::cout << std::dec << std::fixed << std::endl;
+    std::cout << "profile: " << std::setprecision(3) << wall << " s wall, " << (total*sample_us/1e6) << " s CPU ("
+        << total << " samples), " << sc_core::sc_time_stamp() << " simulated" << std::endl;
+    std::cout << "profile: " << sc_core::sc_delta_count() << " delta cycles";
+    if(steps) {
+        std::cout << "; " << steps << " timesteps with instrumented activity (" << std::setprecision(2)
+            << ((double)step_deltas/steps) << " deltas avg, " << step_max << " max)";
+    }
+    std::cout << std::endl;
+    for(unsigned int b=0;b<step_hist.size();++b) {
+        if(!step_hist[b]) continue;
+        uint64_t lo = b ? (1ull<<(b-1)) : 0;
+        uint64_t hi = (1ull<<b) - 1;
+        std::cout << "profile:   " << std::setw(6) << lo << " - " << std::setw(6) << hi << " deltas : "
+            << std::setw(10) << step_hist[b] << " timesteps" << std::endl;
+    }
+    std::cout << "profile: Verilated model (eval) " << std::setprecision(1) << (eval_samples*pct) << "%, scheduler "
+        << (sched_samples*pct) << "%";
+    if(lost_samples) std::cout << ", unattributed " << (lost_samples*pct) << "%";
+    std::cout << std::endl;
+
+    std::cout << "profile: " << std::setw(6) << "cpu %" << std::setw(10) << "samples" << std::setw(13) << "activations"
+        << std::setw(12) << "wall ms" << std::setw(10) << "ns/act" << "  process" << std::endl;
+    for(std::vector<prof_row>::const_iterator it = ranked.begin(); it != ranked.end(); ++it) {
+        std::cout << "profile: " << std::setprecision(1) << std::setw(6) << (it->samples*pct) << std::setw(10) << it->samples;
+        if(it->instrumented) {
+            std::cout << std::setw(13) << it->activations << std::setprecision(3) << std::setw(12) << (it->ns/1e6)
+                << std::setprecision(0) << std::setw(10) << (it->activations ? (double)it->ns/it->activations : 0.0);
+        } else {
+            std::cout << std::setw(13) << "-" << std::setw(12) << "-" << std::setw(10) << "-";
+        }
+        std::cout << "  " << it->name << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6) << std::endl;
+}
+
+void dlsc_bench_counter(const char *name, const uint64_t *count) {
+    bench_counters.push_back(std::make_pair(std::string(name),count));
+}
+
+void dlsc_bench_report_counters(const double wall) {
+    for(unsigned int i=0;i<bench_counters.size();++i) {
+        const uint64_t n = *bench_counters[i].second;
+        std::cout << std::dec << std::fixed << std::setprecision(3) << "bench: " << bench_counters[i].first << ": "
+            << n << " in " << wall << " s (" << (uint64_t)(wall > 0.0 ? n/wall : 0.0) << " /s)" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
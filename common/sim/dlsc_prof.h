@@ -0,0 +1,59 @@
+
+#ifndef DLSC_PROF_H_INCLUDED
+#define DLSC_PROF_H_INCLUDED
+
+#include <stdint.h>
+
+// opt-in simulation profiler; enabled by dlsc_main's --profile
+//
+// Two sources of data:
+//  - SIGPROF sampling (every 1ms of CPU time) charges time to whichever
+//    SystemC process is running; that covers every process, including the
+//    eval method of a Verilated model. Samples taken while no process is
+//    running are charged to the scheduler.
+//  - processes that start with dlsc_prof_process() (e.g. the pin-level TLM
+//    adapters' clk_method) get exact activation counts and wall time. Their
+//    activations also mark timestep boundaries, which is where the delta
+//    cycles per timestep figures come from.
+//
+// dlsc_prof_report prints everything, ranked by CPU time.
+
+// global defined in dlsc_prof.cpp
+extern bool _dlsc_prof_enabled;
+
+struct dlsc_prof_entry;
+
+dlsc_prof_entry *dlsc_prof_enter();
+void dlsc_prof_leave(dlsc_prof_entry *entry, const uint64_t start);
+uint64_t dlsc_prof_now();       // ns; monotonic
+
+// times the enclosing SC_METHOD activation (when enabled)
+class dlsc_prof_scope {
+public:
+    dlsc_prof_scope() : entry(_dlsc_prof_enabled ? dlsc_prof_enter() : 0) {
+        if(entry) start = dlsc_prof_now();
+    }
+    ~dlsc_prof_scope() {
+        if(entry) dlsc_prof_leave(entry,start);
+    }
+private:
+    dlsc_prof_entry     *entry;
+    uint64_t            start;
+};
+
+#define dlsc_prof_process() dlsc_prof_scope _dlsc_prof_scope
+
+// starts sampling; must precede sc_start
+void dlsc_prof_start();
+// stops sampling and prints the report to std::cout
+void dlsc_prof_report();
+
+// named event counts that --bench reports along with simulation speed (e.g.
+// TLPs through a model), as totals and per second of wall time; 'count' must
+// remain valid until the simulation ends
+void dlsc_bench_counter(const char *name, const uint64_t *count);
+// prints a "bench:" line per counter
+void dlsc_bench_report_counters(const double wall);
+
+#endif // DLSC_PROF_H_INCLUDED
+
@@ -3,19 +3,33 @@
 #define DLSC_RAND_H_INCLUDED
 
 #include <stdint.h>
+#include <cassert>
+#include <cstring>
+#include <string>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
 #include <boost/random/bernoulli_distribution.hpp>
 
+// bumped whenever the base seed changes (defined in dlsc_main.cpp); generators
+// that derive their seed from it notice the change on their next use and
+// reseed themselves (e.g. for experiments forked from a checkpoint)
+extern uint32_t _dlsc_random_epoch;
+
 class dlsc_random
 {
 public:
     dlsc_random() :
-        gen_(dlsc_random::get_seed())
+        gen_(dlsc_random::get_seed()),
+        hash_(0),
+        named_(false),
+        epoch_(_dlsc_random_epoch)
     {
     }
 
+    // seeded from the base seed and 'name' only (see dlsc_random_stream)
+    explicit dlsc_random(std::string const &name);
+
     template <typename T>
     T operator() (T const min, T const max)
     {
@@ -28,40 +42,319 @@ public:
     bool rand_bool(double const p)
     {
         assert(p >= 0.0 && p <= 1.0);
+        if(epoch_ != _dlsc_random_epoch) reseed();
         boost::random::bernoulli_distribution<double> dist(p);
         return dist(gen_);
     }
 
+    // reseeds this generator
+    void seed(uint32_t const s)
+    {
+        gen_.seed(s);
+        epoch_ = _dlsc_random_epoch;
+    }
+
+    // sets the base seed that subsequently constructed generators derive theirs from
+    static void set_base_seed(uint32_t const s);
+
+    // base seed for this run (PARAM_RAND_SEED, or as last set by set_base_seed)
+    static uint32_t get_base_seed();
+
+    static uint32_t get_seed();
+
 private:
     boost::mt19937 gen_;
+    uint64_t hash_;         // of the name (if named_)
+    bool named_;
+    uint32_t epoch_;
 
-private:
-    static uint32_t get_seed();
+    void reseed();
 };
 
 template <typename T>
 T dlsc_random::rand(T const min, T const max)
 {
     assert(min <= max);
+    if(epoch_ != _dlsc_random_epoch) reseed();
     boost::random::uniform_int_distribution<T> dist(min, max);
     return dist(gen_);
 }
 
 template <>
-double dlsc_random::rand(double const min, double const max)
+inline double dlsc_random::rand(double const min, double const max)
 {
     assert(min <= max);
+    if(epoch_ != _dlsc_random_epoch) reseed();
     boost::random::uniform_real_distribution<double> dist(min, max);
     return dist(gen_);
 }
 
 template <>
-float dlsc_random::rand(float const min, float const max)
+inline float dlsc_random::rand(float const min, float const max)
 {
     assert(min <= max);
+    if(epoch_ != _dlsc_random_epoch) reseed();
     boost::random::uniform_real_distribution<float> dist(min, max);
     return dist(gen_);
 }
 
+// Counter-based (Philox4x32-10) generator for a named stream.
+//
+// A stream's key is derived from the base seed and its name (typically the
+// owning module's hierarchical name), and its output is a pure function of
+// that key and a block counter. Streams are independent of each other and of
+// construction order: adding, removing or reordering components in a
+// testbench doesn't disturb any other component's randomness. set_counter()
+// allows random access (e.g. regenerating frame N without generating 0..N-1).
+// Streams keyed from the base seed are rekeyed (and restarted) when it changes.
+class dlsc_random_stream
+{
+public:
+    explicit dlsc_random_stream(std::string const &name) :
+        hash_(name_hash(name)),
+        follow_(true)
+    {
+        set_key(dlsc_random::get_base_seed());
+    }
+
+    dlsc_random_stream(std::string const &name, uint64_t const seed) :
+        hash_(name_hash(name)),
+        follow_(false)
+    {
+        set_key(seed);
+    }
+
+    // key derived from 'name' and 'seed' (as the constructors do)
+    static uint64_t make_key(std::string const &name, uint64_t const seed)
+    {
+        return mix(name_hash(name),seed);
+    }
+
+    static uint64_t name_hash(std::string const &name);
+    static uint64_t mix(uint64_t const hash, uint64_t const seed);
+
+    // restarts the stream at the given 128-bit block
+    void set_counter(uint64_t const block)
+    {
+        ctr_ = block;
+        idx_ = 4;
+    }
+
+    uint32_t next_u32()
+    {
+        if(epoch_ != _dlsc_random_epoch) rekey();
+        if(idx_ >= 4) {
+            block(ctr_++,buf_);
+            idx_ = 0;
+        }
+        return buf_[idx_++];
+    }
+
+    uint64_t next_u64()
+    {
+        uint64_t hi = next_u32();
+        return (hi << 32) | next_u32();
+    }
+
+    // uniform in [0,n); n must be non-zero
+    uint32_t below(uint32_t const n);
+
+    // uniform in [min,max]
+    template <typename T>
+    T rand(T const min, T const max);
+
+    // true with probability pct/100
+    bool chance(double const pct)
+    {
+        return uniform() * 100.0 < pct;
+    }
+
+    // uniform in [0,1)
+    double uniform()
+    {
+        return (next_u64() >> 11) * (1.0/9007199254740992.0);
+    }
+
+    // fills 'bytes' bytes with random data; whole blocks are generated
+    // directly into the destination
+    void fill_bytes(void *data, size_t bytes);
+
+    // fills with uniformly distributed values (all bits random)
+    template <typename T>
+    void fill(T *data, size_t const n)
+    {
+        fill_bytes(data,n*sizeof(T));
+    }
+
+    // fills with values uniform in [min,max]
+    template <typename T>
+    void fill(T *data, size_t const n, T const min, T const max)
+    {
+        for(size_t i=0;i<n;++i) data[i] = rand<T>(min,max);
+    }
+
+private:
+    uint32_t key_[2];
+    uint64_t ctr_;
+    uint32_t buf_[4];
+    unsigned int idx_;
+    uint64_t hash_;
+    bool follow_;           // keyed from the base seed
+    uint32_t epoch_;
+
+    void set_key(uint64_t const seed)
+    {
+        uint64_t k = mix(hash_,seed);
+        key_[0] = (uint32_t)k;
+        key_[1] = (uint32_t)(k >> 32);
+        ctr_    = 0;
+        idx_    = 4;
+        epoch_  = _dlsc_random_epoch;
+    }
+
+    void rekey()
+    {
+        if(follow_) {
+            set_key(dlsc_random::get_base_seed());
+        } else {
+            epoch_ = _dlsc_random_epoch;
+        }
+    }
+
+    void block(uint64_t const n, uint32_t out[4]) const;
+};
+
+inline uint64_t dlsc_random_stream::name_hash(std::string const &name)
+{
+    // FNV-1a
+    uint64_t h = 0xCBF29CE484222325ull;
+    for(size_t i=0;i<name.size();++i) {
+        h ^= (uint8_t)name[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+inline uint64_t dlsc_random_stream::mix(uint64_t const hash, uint64_t const seed)
+{
+    // splitmix64 finalizer over name hash and seed
+    uint64_t z = hash + 0x9E3779B97F4A7C15ull * (seed + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline void dlsc_random_stream::block(uint64_t const n, uint32_t out[4]) const
+{
+    uint32_t c0 = (uint32_t)n, c1 = (uint32_t)(n >> 32), c2 = 0, c3 = 0;
+    uint32_t k0 = key_[0], k1 = key_[1];
+    for(int r=0;r<10;++r) {
+        uint64_t p0 = (uint64_t)0xD2511F53u * c0;
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+inline uint32_t dlsc_random_stream::below(uint32_t const n)
+{
+    assert(n > 0);
+    // Lemire's multiply-and-reject; unbiased
+    uint64_t m = (uint64_t)next_u32() * n;
+    uint32_t l = (uint32_t)m;
+    if(l < n) {
+        uint32_t t = (0u - n) % n;
+        while(l < t) {
+            m = (uint64_t)next_u32() * n;
+            l = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+template <typename T>
+T dlsc_random_stream::rand(T const min, T const max)
+{
+    assert(min <= max);
+    uint64_t span = (uint64_t)max - (uint64_t)min;
+    if(span < 0xFFFFFFFFull) {
+        return (T)(min + (T)below((uint32_t)span + 1));
+    }
+    if(span == 0xFFFFFFFFFFFFFFFFull) {
+        return (T)next_u64();
+    }
+    // rejection on the smallest enclosing power of 2
+    uint64_t mask = span;
+    mask |= mask >> 1; mask |= mask >> 2; mask |= mask >> 4;
+    mask |= mask >> 8; mask |= mask >> 16; mask |= mask >> 32;
+    uint64_t v;
+    do { v = next_u64() & mask; } while(v > span);
+    return (T)(min + (T)v);
+}
+
+template <>
+inline double dlsc_random_stream::rand(double const min, double const max)
+{
+    assert(min <= max);
+    return min + (max - min) * uniform();
+}
+
+template <>
+inline float dlsc_random_stream::rand(float const min, float const max)
+{
+    assert(min <= max);
+    return min + (max - min) * (float)uniform();
+}
+
+inline void dlsc_random_stream::fill_bytes(void *data, size_t bytes)
+{
+    if(epoch_ != _dlsc_random_epoch) rekey();
+    uint8_t *ptr = static_cast<uint8_t*>(data);
+    // drain any buffered words first, so the output is the same as repeated next_u32()
+    while(bytes > 0 && idx_ < 4) {
+        uint32_t v = buf_[idx_++];
+        size_t n = bytes < 4 ? bytes : 4;
+        std::memcpy(ptr,&v,n);
+        ptr += n; bytes -= n;
+    }
+    uint32_t out[4];
+    while(bytes >= sizeof(out)) {
+        block(ctr_++,out);
+        std::memcpy(ptr,out,sizeof(out));
+        ptr += sizeof(out); bytes -= sizeof(out);
+    }
+    while(bytes > 0) {
+        uint32_t v = next_u32();
+        size_t n = bytes < 4 ? bytes : 4;
+        std::memcpy(ptr,&v,n);
+        ptr += n; bytes -= n;
+    }
+}
+
+inline dlsc_random::dlsc_random(std::string const &name) :
+    gen_((uint32_t)dlsc_random_stream::make_key(name,dlsc_random::get_base_seed())),
+    hash_(dlsc_random_stream::name_hash(name)),
+    named_(true),
+    epoch_(_dlsc_random_epoch)
+{
+}
+
+inline void dlsc_random::reseed()
+{
+    if(named_) {
+        gen_.seed((uint32_t)dlsc_random_stream::mix(hash_,dlsc_random::get_base_seed()));
+    } else {
+        gen_.seed(dlsc_random::get_seed());
+    }
+    epoch_ = _dlsc_random_epoch;
+}
+
 #endif // DLSC_RAND_H_INCLUDED
 
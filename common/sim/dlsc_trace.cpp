@@ -0,0 +1,270 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <deque>
+#include <map>
+#include <iostream>
+#include <csignal>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "dlsc_trace.h"
+
+namespace {
+
+bool ends_with(const std::string &s, const char *suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size()-n,n,suffix) == 0;
+}
+
+// opens the final output; compressed formats go through an external converter
+FILE *sink_open(const std::string &file, bool &piped) {
+    piped = true;
+    if(ends_with(file,".fst")) {
+        return popen(("vcd2fst /dev/stdin '" + file + "' > /dev/null").c_str(),"w");
+    }
+    if(ends_with(file,".gz")) {
+        return popen(("gzip -c > '" + file + "'").c_str(),"w");
+    }
+    piped = false;
+    return fopen(file.c_str(),"w");
+}
+
+void sink_close(FILE *f, const bool piped) {
+    if(piped) pclose(f); else fclose(f);
+}
+
+// whitespace-delimited VCD tokenizer
+class vcd_reader {
+public:
+    vcd_reader(FILE *f) : f(f) { }
+
+    bool next(std::string &tok) {
+        tok.clear();
+        int c;
+        while((c = getc_unlocked(f)) != EOF && isspace(c));
+        if(c == EOF) return false;
+        do { tok += (char)c; } while((c = getc_unlocked(f)) != EOF && !isspace(c));
+        return true;
+    }
+
+private:
+    FILE *f;
+};
+
+// VCD time units per ns, from a $timescale body (e.g. "1ps" or "10 ns")
+double units_per_ns(const std::string &ts) {
+    double mult = atof(ts.c_str());
+    if(mult <= 0.0) mult = 1.0;
+    double unit = 1e-9;
+    if(ts.find("fs") != std::string::npos) unit = 1e-15;
+    else if(ts.find("ps") != std::string::npos) unit = 1e-12;
+    else if(ts.find("ns") != std::string::npos) unit = 1e-9;
+    else if(ts.find("us") != std::string::npos) unit = 1e-6;
+    else if(ts.find("ms") != std::string::npos) unit = 1e-3;
+    else if(ts.find("s") != std::string::npos) unit = 1.0;
+    return 1e-9 / (mult * unit);
+}
+
+// signal id of a value change line ("1!" or "b0101 #")
+std::string change_id(const std::string &line) {
+    if(line[0] == 'b' || line[0] == 'B' || line[0] == 'r' || line[0] == 'R') {
+        return line.substr(line.find(' ')+1);
+    }
+    return line.substr(1);
+}
+
+struct vcd_chunk {
+    unsigned long long  start;
+    std::string         text;       // "#<time>" and value change lines
+};
+
+// folds a chunk's changes into the signal state
+void apply_chunk(std::map<std::string,std::string> &state, const vcd_chunk &chunk) {
+    size_t pos = 0;
+    while(pos < chunk.text.size()) {
+        size_t eol = chunk.text.find('\n',pos);
+        if(chunk.text[pos] != '#') {
+            std::string line = chunk.text.substr(pos,eol-pos);
+            state[change_id(line)] = line;
+        }
+        pos = eol + 1;
+    }
+}
+
+void copy_stream(FILE *in, FILE *out) {
+    char buf[65536];
+    size_t n;
+    while((n = fread(buf,1,sizeof(buf),in)) > 0) {
+        fwrite(buf,1,n,out);
+    }
+}
+
+// keeps the last 'ring_ns' of the trace; writes it out at end of input
+void ring_stream(FILE *in, FILE *out, const double ring_ns) {
+    vcd_reader rd(in);
+    std::string tok, id;
+    std::string header, timescale;
+
+    // header is kept as-is (modulo whitespace)
+    bool in_timescale = false;
+    while(rd.next(tok)) {
+        header += tok;
+        if(tok == "$end") {
+            header += '\n';
+            in_timescale = false;
+        } else {
+            header += ' ';
+            if(in_timescale) timescale += tok;
+            if(tok == "$timescale") in_timescale = true;
+        }
+        if(tok == "$enddefinitions") {
+            rd.next(tok);           // $end
+            header += "$end\n";
+            break;
+        }
+    }
+
+    if(header.empty()) return;
+
+    const double upn = units_per_ns(timescale);
+    unsigned long long ring = (unsigned long long)(ring_ns * upn);
+    if(ring == 0) ring = 1;
+    const unsigned long long chunk_len = (ring >= 4) ? (ring/4) : 1;
+
+    // window is [chunks.front().start,now]; 'state' holds every signal's value as of its start
+    std::deque<vcd_chunk> chunks;
+    std::map<std::string,std::string> state;
+
+    while(rd.next(tok)) {
+        if(tok[0] == '$') {
+            // $dumpvars/$dumpon/etc. just bracket value changes; skip comments entirely
+            if(tok == "$comment") {
+                while(rd.next(tok) && tok != "$end");
+            }
+            continue;
+        }
+
+        if(tok[0] == '#') {
+            unsigned long long t = strtoull(tok.c_str()+1,NULL,10);
+            if(chunks.empty() || t - chunks.back().start >= chunk_len) {
+                chunks.push_back(vcd_chunk());
+                chunks.back().start = t;
+            }
+            chunks.back().text += tok;
+            chunks.back().text += '\n';
+            // retire the oldest chunk once the one after it already spans the window
+            while(chunks.size() > 1 && t - chunks[1].start >= ring) {
+                apply_chunk(state,chunks.front());
+                chunks.pop_front();
+            }
+            continue;
+        }
+
+        if(chunks.empty()) {
+            chunks.push_back(vcd_chunk());
+            chunks.back().start = 0;
+            chunks.back().text = "#0\n";
+        }
+
+        std::string &text = chunks.back().text;
+        text += tok;
+        if(tok[0] == 'b' || tok[0] == 'B' || tok[0] == 'r' || tok[0] == 'R') {
+            rd.next(id);
+            text += ' ';
+            text += id;
+        }
+        text += '\n';
+    }
+
+    fputs(header.c_str(),out);
+
+    if(chunks.empty()) return;
+
+    size_t skip = 0;
+    if(!state.empty()) {
+        // initial values for the window, at the window's first timestamp
+        // (which replaces the first chunk's own timestamp line)
+        fprintf(out,"#%llu\n$dumpvars\n",chunks.front().start);
+        for(std::map<std::string,std::string>::const_iterator it = state.begin(); it != state.end(); ++it) {
+            fputs(it->second.c_str(),out);
+            fputc('\n',out);
+        }
+        fputs("$end\n",out);
+        skip = chunks.front().text.find('\n') + 1;
+    }
+
+    for(size_t i=0;i<chunks.size();++i) {
+        fputs(chunks[i].text.c_str() + (i == 0 ? skip : 0),out);
+    }
+}
+
+} // end anonymous namespace
+
+std::string dlsc_trace_spawn(const std::string &file, const double ring_ns, pid_t &pid) {
+    pid = 0;
+
+    if(ring_ns <= 0.0 && !ends_with(file,".gz") && !ends_with(file,".fst")) {
+        // SpTraceFile can write this directly
+        return file;
+    }
+
+    std::string fifo = file + ".fifo";
+    unlink(fifo.c_str());
+    if(mkfifo(fifo.c_str(),0600) != 0) {
+        std::cerr << "dlsc_trace: failed to create " << fifo << "; writing plain VCD" << std::endl;
+        return file;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    pid = fork();
+    if(pid < 0) {
+        std::cerr << "dlsc_trace: fork() failed; writing plain VCD" << std::endl;
+        pid = 0;
+        unlink(fifo.c_str());
+        return file;
+    }
+
+    if(pid == 0) {
+        // writer; blocks until the simulator opens the trace
+        FILE *in = fopen(fifo.c_str(),"r");
+        bool piped;
+        FILE *out = in ? sink_open(file,piped) : NULL;
+        if(!in || !out) {
+            std::cerr << "dlsc_trace: failed to open " << (in ? file : fifo) << std::endl;
+            // keep draining, so the simulator doesn't block
+            if(in) { out = fopen("/dev/null","w"); piped = false; }
+            if(!out) _exit(1);
+        }
+        if(ring_ns > 0.0) {
+            ring_stream(in,out,ring_ns);
+        } else {
+            copy_stream(in,out);
+        }
+        sink_close(out,piped);
+        fclose(in);
+        _exit(0);
+    }
+
+    return fifo;
+}
+
+void dlsc_trace_finish(const std::string &path, const pid_t pid, const bool opened) {
+    if(!pid) return;
+
+    if(!opened) {
+        // writer is still waiting for the trace to be opened
+        kill(pid,SIGTERM);
+    }
+
+    int status;
+    waitpid(pid,&status,0);
+    unlink(path.c_str());
+}
+
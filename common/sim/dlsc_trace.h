@@ -0,0 +1,36 @@
+
+#ifndef DLSC_TRACE_H_INCLUDED
+#define DLSC_TRACE_H_INCLUDED
+
+#include <string>
+#include <sys/types.h>
+
+// post-processing for the VCD stream written by SpTraceFile; used by dlsc_main.cpp
+//
+// Output format follows the trace file's name:
+//   *.vcd      plain VCD
+//   *.vcd.gz   VCD, compressed through gzip
+//   *.fst      FST, converted on the fly by GTKWave's vcd2fst
+//
+// With a non-zero ring_ns, only the last ring_ns (or a little more) of
+// simulation time is kept (flight recorder); the window is written out once
+// the trace is closed. Signal values at the start of the window are
+// reconstructed, so the result is a self-contained VCD.
+//
+// Ring mode saves disk, not simulation time: since the window's end (the
+// first error, or the end of simulation) isn't known in advance, the whole
+// run is still traced, formatted and parsed by the writer. Only when
+// --trace-stop is also given does dlsc_main delay tracing to the window.
+
+// prepares for tracing to 'file'; returns the path SpTraceFile should open.
+// For plain, unwindowed VCD, that's just 'file'; otherwise, it's a fifo that
+// a forked writer process reads (returned through 'pid').
+std::string dlsc_trace_spawn(const std::string &file, const double ring_ns, pid_t &pid);
+
+// waits for the writer (if any) to finish; 'path' is the value returned by
+// dlsc_trace_spawn. Must be called after the trace file is closed; 'opened'
+// indicates whether it was ever opened.
+void dlsc_trace_finish(const std::string &path, const pid_t pid, const bool opened);
+
+#endif // DLSC_TRACE_H_INCLUDED
+
@@ -0,0 +1,286 @@
+#!/usr/bin/perl -w
+
+# regression driver: runs every simulation configuration of every testbench
+# makefile (the sims0..sims3 and dlsc-sim targets), as independent jobs on
+# N cores. Jobs are started longest-first, using runtimes recorded by earlier
+# regressions, so the total wall time approaches that of the longest job.
+#
+# usage (from the repository root):
+#   common/tools/dlsc_regress.pl [-j <jobs>] [--filter <regex>] [--target <make target>]
+#       [--db <file>] [--out <dir>] [--junit <file>] [--json <file>] [--list]
+#       [<testbench makefile> ...]
+#
+# makefiles default to */tb/*_tb.makefile and */tb/*_tbv.makefile; --filter selects by makefile and
+# parameters ("<makefile> <V_PARAMS>"). Each job's output goes to <out>/.
+
+use strict;
+use IO::File;
+use Getopt::Long;
+use File::Basename;
+use File::Path;
+use File::Spec;
+use Cwd qw(abs_path);
+use POSIX qw(:sys_wait_h);
+use Time::HiRes qw(time);
+
+my $jobs    = `nproc` + 0 || 1;
+my $filter;
+my $target  = "sim";
+my $db      = ".dlsc_regress_times";
+my $out     = "_work/regress";
+my $junit;
+my $json;
+my $list    = 0;
+
+if (! GetOptions(
+        "j|jobs=i"  => \$jobs,
+        "filter=s"  => \$filter,
+        "target=s"  => \$target,
+        "db=s"      => \$db,
+        "out=s"     => \$out,
+        "junit=s"   => \$junit,
+        "json=s"    => \$json,
+        "list"      => \$list
+    )) {
+        die "bad usage";
+}
+
+$out = File::Spec->rel2abs($out);
+my @makefiles = @ARGV ? @ARGV : sort glob("*/tb/*_tb.makefile */tb/*_tbv.makefile");
+
+# ** collect configurations **
+
+my @all;
+foreach my $mf (@makefiles) {
+    my $dir = dirname(abs_path($mf));
+    my $name = basename($mf);
+    # sims_list prints the command each sims target would run
+    my @lines = `cd '$dir' && make -s --no-print-directory -f '$name' sims_list 2>/dev/null`;
+    my %seen;
+    my @params;
+    foreach (@lines) {
+        chomp;
+        next unless /^V_PARAMS: .*V_PARAMS=(.*)$/;
+        my $p = join(" ", sort split(" ", $1));
+        push @params, $p unless $seen{$p}++;
+    }
+    @params = ("") unless @params;      # no sims targets; just the defaults
+    foreach my $p (@params) {
+        my $key = ($p ne "") ? "$mf $p" : $mf;
+        next if (defined $filter && $key !~ /$filter/);
+        push @all, { makefile => $mf, dir => $dir, name => $name, params => $p, key => $key };
+    }
+}
+
+# ** estimate and order **
+
+my %history;
+if (my $fh = IO::File->new("<$db")) {
+    while (<$fh>) {
+        chomp;
+        my ($t, $k) = split(/\t/, $_, 2);
+        $history{$k} = $t if defined $k;
+    }
+}
+
+# unknown jobs go first (as if they were the longest), so they don't become the tail
+my $longest = 0;
+foreach my $j (@all) {
+    $longest = $history{$j->{key}} if (defined $history{$j->{key}} && $history{$j->{key}} > $longest);
+}
+foreach my $j (@all) {
+    $j->{estimate} = defined $history{$j->{key}} ? $history{$j->{key}} : $longest + 1;
+}
+@all = sort { $b->{estimate} <=> $a->{estimate} || $a->{key} cmp $b->{key} } @all;
+
+if ($list) {
+    foreach my $j (@all) {
+        printf("%10s  %s\n", defined $history{$j->{key}} ? sprintf("%.1f", $j->{estimate}) : "?", $j->{key});
+    }
+    exit 0;
+}
+
+printf("%d configurations from %d makefiles; %d jobs\n", scalar(@all), scalar(@makefiles), $jobs);
+
+# ** run **
+
+mkpath($out);
+
+my %running;            # pid => job
+my @pending = @all;
+my $start = time();
+my $done = 0;
+
+while (@pending || %running) {
+    while (@pending && scalar(keys %running) < $jobs) {
+        my $j = shift @pending;
+        my $base = $j->{name};
+        $base =~ s/\.makefile$//;
+        my $tag = $j->{params};
+        $tag =~ s/[^A-Za-z0-9_=.-]+/_/g;
+        $j->{output} = "$out/$base" . ($tag ne "" ? "__$tag" : "") . ".out";
+        # the simulation is always rerun (a current log would otherwise be reused)
+        $j->{log} = log_path($j);
+        unlink($j->{log}) if $j->{log} ne "";
+        $j->{start} = time();
+        my $pid = fork();
+        die "fork failed" unless defined $pid;
+        if ($pid == 0) {
+            chdir($j->{dir}) or exit 1;
+            open(STDOUT, ">", $j->{output}) or exit 1;
+            open(STDERR, ">&STDOUT");
+            exec("make", "--no-print-directory", "-f", $j->{name}, "V_PARAMS=$j->{params}", $target);
+            exit 1;
+        }
+        $running{$pid} = $j;
+    }
+
+    my $pid = wait();
+    last if $pid < 0;
+    my $j = delete $running{$pid} or next;
+    $j->{time} = time() - $j->{start};
+    $j->{exit} = $?;
+    result($j);
+    $done++;
+
+    # exponentially weighted, so one unusual run doesn't dominate
+    my $k = $j->{key};
+    $history{$k} = defined $history{$k} ? 0.5*$history{$k} + 0.5*$j->{time} : $j->{time};
+
+    printf("[%3d/%3d] %-4s %8.1fs  %s\n", $done, scalar(@all), $j->{status}, $j->{time}, $j->{key});
+}
+
+my $wall = time() - $start;
+
+if (my $fh = IO::File->new(">$db.tmp")) {
+    foreach my $k (sort keys %history) {
+        printf $fh ("%.3f\t%s\n", $history{$k}, $k);
+    }
+    $fh->close();
+    rename("$db.tmp", $db);
+}
+
+# ** report **
+
+my @failed = grep { $_->{status} ne "PASS" } @all;
+my $longest_job = 0;
+my $cpu = 0;
+foreach my $j (@all) {
+    $longest_job = $j->{time} if $j->{time} > $longest_job;
+    $cpu += $j->{time};
+}
+
+printf("\n%d passed, %d failed; %.1fs wall (longest job %.1fs, %.1fs total)\n",
+    scalar(@all) - scalar(@failed), scalar(@failed), $wall, $longest_job, $cpu);
+foreach my $j (@failed) {
+    printf("  %s %s: %s (%s)\n", $j->{status}, $j->{key}, $j->{message}, $j->{output});
+}
+
+write_junit($junit) if $junit;
+write_json($json) if $json;
+
+exit(@failed ? 1 : 0);
+
+
+# where a configuration's simulation log ends up
+sub log_path {
+    my ($j) = @_;
+    my $log = `cd '$j->{dir}' && make -s --no-print-directory -f '$j->{name}' 'V_PARAMS=$j->{params}' log_path 2>/dev/null`;
+    chomp $log;
+    return $log;
+}
+
+# determines a finished job's status from make's exit code and the simulation log
+sub result {
+    my ($j) = @_;
+
+    my $summary;
+    if (my $fh = IO::File->new("<$j->{log}")) {
+        while (<$fh>) {
+            $summary = $1 if /(\*\*\* (PASSED|FAILED).*)$/;
+        }
+    }
+
+    if ($j->{exit} != 0) {
+        $j->{status}  = "FAIL";
+        $j->{message} = ($j->{exit} & 127) ? sprintf("make killed by signal %d", $j->{exit} & 127) :
+            sprintf("make exited with %d", $j->{exit} >> 8);
+    } elsif (!defined $summary) {
+        $j->{status}  = "FAIL";
+        $j->{message} = "no result in log";
+    } elsif ($summary =~ /PASSED/) {
+        $j->{status}  = "PASS";
+        $j->{message} = $summary;
+    } else {
+        $j->{status}  = "FAIL";
+        $j->{message} = $summary;
+    }
+}
+
+sub xml_escape {
+    my ($s) = @_;
+    $s =~ s/&/&amp;/g;
+    $s =~ s/</&lt;/g;
+    $s =~ s/>/&gt;/g;
+    $s =~ s/"/&quot;/g;
+    return $s;
+}
+
+sub json_escape {
+    my ($s) = @_;
+    $s =~ s/\\/\\\\/g;
+    $s =~ s/"/\\"/g;
+    $s =~ s/([\x00-\x1f])/sprintf("\\u%04x",ord($1))/ge;
+    return "\"$s\"";
+}
+
+# one testsuite per makefile; one testcase per configuration
+sub write_junit {
+    my ($file) = @_;
+    my $fh = IO::File->new(">$file") or die "failed to open $file";
+    my %suites;
+    foreach my $j (@all) {
+        push @{$suites{$j->{makefile}}}, $j;
+    }
+    printf $fh ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    printf $fh ("<testsuites tests=\"%d\" failures=\"%d\" time=\"%.3f\">\n", scalar(@all), scalar(@failed), $wall);
+    foreach my $mf (sort keys %suites) {
+        my @cases = @{$suites{$mf}};
+        my $t = 0;
+        $t += $_->{time} foreach @cases;
+        my $nfail = grep { $_->{status} ne "PASS" } @cases;
+        my $class = $mf;
+        $class =~ s/\.makefile$//;
+        $class =~ s/\//./g;
+        printf $fh ("  <testsuite name=\"%s\" tests=\"%d\" failures=\"%d\" time=\"%.3f\">\n",
+            xml_escape($mf), scalar(@cases), $nfail, $t);
+        foreach my $j (@cases) {
+            printf $fh ("    <testcase classname=\"%s\" name=\"%s\" time=\"%.3f\">\n",
+                xml_escape($class), xml_escape($j->{params} ne "" ? $j->{params} : "default"), $j->{time});
+            if ($j->{status} ne "PASS") {
+                printf $fh ("      <failure message=\"%s\"/>\n", xml_escape($j->{message}));
+            }
+            printf $fh ("      <system-out>%s</system-out>\n", xml_escape("log: $j->{log}\noutput: $j->{output}"));
+            printf $fh ("    </testcase>\n");
+        }
+        printf $fh ("  </testsuite>\n");
+    }
+    printf $fh ("</testsuites>\n");
+    $fh->close();
+}
+
+sub write_json {
+    my ($file) = @_;
+    my $fh = IO::File->new(">$file") or die "failed to open $file";
+    printf $fh ("{\n  \"wall\": %.3f,\n  \"jobs\": %d,\n  \"passed\": %d,\n  \"failed\": %d,\n  \"results\": [\n",
+        $wall, $jobs, scalar(@all) - scalar(@failed), scalar(@failed));
+    for (my $i = 0; $i < @all; $i++) {
+        my $j = $all[$i];
+        printf $fh ("    { \"makefile\": %s, \"params\": %s, \"status\": %s, \"time\": %.3f, \"estimate\": %.3f, \"message\": %s, \"log\": %s, \"output\": %s }%s\n",
+            json_escape($j->{makefile}), json_escape($j->{params}), json_escape($j->{status}),
+            $j->{time}, $j->{estimate}, json_escape($j->{message}), json_escape($j->{log}),
+            json_escape($j->{output}), ($i+1 < @all) ? "," : "");
+    }
+    printf $fh ("  ]\n}\n");
+    $fh->close();
+}
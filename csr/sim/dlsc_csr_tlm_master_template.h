@@ -105,6 +105,8 @@ void dlsc_csr_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback(transactio
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_csr_tlm_master_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         csr_cmd_valid   = 0;
         csr_cmd_write   = 0;
@@ -72,6 +72,8 @@ dlsc_csr_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_csr_tlm_slave_template(
 
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_csr_tlm_slave_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         csr_rsp_valid   = 0;
         csr_rsp_error   = 0;
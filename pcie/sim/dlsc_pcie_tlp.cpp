@@ -1,6 +1,8 @@
 
 #include <stdexcept>
 #include <iomanip>
+#include <algorithm>
+#include <cassert>
 
 #include <systemc>
 
@@ -12,6 +14,14 @@ using namespace std;
 using namespace sc_dt;
 using namespace dlsc::pcie;
 
+// payload is big-endian on the wire
+static inline uint32_t swap_endian(uint32_t ds) {
+    return ((ds & 0x000000FF) << 24) |
+           ((ds & 0x0000FF00) <<  8) |
+           ((ds & 0x00FF0000) >>  8) |
+           ((ds & 0xFF000000) >> 24);
+}
+
 pcie_tlp::pcie_tlp() : name_str("pcie_tlp") {
     clear();
 }
@@ -258,14 +268,32 @@ void pcie_tlp::set_destination(unsigned int id) {
     dest_id      = id;
 }
 
+void pcie_tlp::set_data(pcie_const_dw_span dw) {
+    set_length(dw.size());
+    set_format(fmt_4dw ? FMT_4DW_DATA : FMT_3DW_DATA);
+    data.assign(dw.begin(),dw.end());
+}
+
 void pcie_tlp::set_data(const deque<uint32_t> &dw) {
     set_length(dw.size());
     set_format(fmt_4dw ? FMT_4DW_DATA : FMT_3DW_DATA);
-    data        = dw;
+    data.assign(dw.begin(),dw.end());
 }
 
 
 bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
+    if(dw.size() > max_dw) {
+        clear();
+        dlsc_error("incorrect payload data length (have " << dw.size() << " dwords; more than any TLP)");
+        malformed = true;
+        return false;
+    }
+    uint32_t buf[max_dw];
+    std::copy(dw.begin(),dw.end(),buf);
+    return deserialize(pcie_const_dw_span(buf,dw.size()));
+}
+
+bool pcie_tlp::deserialize(pcie_const_dw_span dw) {
     clear();
 
     if(dw.empty()) {
@@ -275,7 +303,7 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
     sc_int<32> d;
 
     // ** bytes 0-3
-    d           = dw.at(0);
+    d           = dw[0];
 
     // format/header-size
     if(!set_format( static_cast<pcie_fmt>((int)d.range(30,29)) )) {
@@ -313,7 +341,7 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
     }
 
     // ** bytes 4-7
-    d           = dw.at(1);
+    d           = dw[1];
 
     src_id      = d.range(31,16);
 
@@ -341,7 +369,7 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
 
     // ** bytes 8-11
 
-    d           = dw.at(2);
+    d           = dw[2];
 
     if(type_mem || type_io || type == TYPE_MSG_BY_ADDR) {
         dest_addr   = 0;
@@ -349,7 +377,7 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
             dest_addr   = d;
             dest_addr   <<= 32;
             // ** bytes 12-15
-            d           = dw.at(3);
+            d           = dw[3];
         }
             
         dest_addr   |= d.range(31,2) << 2;
@@ -379,7 +407,7 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
     }
 
     if(type_msg && type != TYPE_MSG_BY_ADDR && type != TYPE_MSG_BY_ID) {
-        if(dw.at(2) != 0 || (fmt_4dw && dw.at(3) != 0)) {
+        if(dw[2] != 0 || (fmt_4dw && dw[3] != 0)) {
             dlsc_warn("reserved bits non-zero");
         }
     }
@@ -398,25 +426,16 @@ bool pcie_tlp::deserialize(const deque<uint32_t> &dw) {
         }
     }
 
-    // copy payload
+    // copy payload (swapping endianness)
     if(fmt_data) {
-        data.assign(dw.begin()+fmt_size,dw.end()-digest_size);
-    }
-    
-    // swap endianness
-    std::deque<uint32_t>::iterator it;
-    for(it = data.begin();it != data.end();it++) {
-        uint32_t ds = *it;
-        *it = ((ds & 0x000000FF) << 24) |
-              ((ds & 0x0000FF00) <<  8) |
-              ((ds & 0x00FF0000) >>  8) |
-              ((ds & 0xFF000000) >> 24);
+        data.resize(length);
+        std::transform(dw.begin()+fmt_size,dw.end()-digest_size,data.begin(),swap_endian);
     }
 
     // ** digest
     if(td) {
         // TODO: endianness of digest may be wrong
-        digest      = dw.back();
+        digest      = dw[dw.size()-1];
     }
 
     return true;
@@ -473,7 +492,19 @@ bool pcie_tlp::validate() const {
 }
 
 void pcie_tlp::serialize(deque<uint32_t> &dw) const {
+    uint32_t buf[max_dw];
+    unsigned int n = serialize(pcie_dw_span(buf,max_dw));
+    dw.insert(dw.end(),buf,buf+n);
+}
+
+unsigned int pcie_tlp::serialize(pcie_dw_span dw) const {
 
+    const unsigned int n = wire_size();
+    if(dw.size() < n) {
+        throw invalid_argument("insufficient space to serialize TLP");
+    }
+
+    uint32_t *p = dw.begin();
     sc_int<32> d;
 
     // ** bytes 0-3
@@ -488,7 +519,7 @@ void pcie_tlp::serialize(deque<uint32_t> &dw) const {
     d[12]           = attr_ns;
     d.range(9,0)    = (length == 1024) ? 0 : length;
 
-    dw.push_back(d);
+    *p++            = d;
     
     // ** bytes 4-7
     d               = 0;
@@ -514,15 +545,15 @@ void pcie_tlp::serialize(deque<uint32_t> &dw) const {
         d.range(7,0)    = msg_code;
     }
     
-    dw.push_back(d);
+    *p++            = d;
 
     // ** bytes 8-11/15
     
     if(type_mem || type_io || type == TYPE_MSG_BY_ADDR) {
         if(fmt_4dw) {
-            dw.push_back(dest_addr >> 32);
+            *p++            = dest_addr >> 32;
         }
-        dw.push_back(dest_addr & 0xFFFFFFFC);
+        *p++            = dest_addr & 0xFFFFFFFC;
     } else {
         d               = 0;
 
@@ -539,32 +570,27 @@ void pcie_tlp::serialize(deque<uint32_t> &dw) const {
             d.range(11,2)   = cfg_reg;
         }
 
-        dw.push_back(d);
+        *p++            = d;
 
         if(fmt_4dw) {
-            dw.push_back(0);
+            *p++            = 0;
         }
     }
 
     // ** payload
     if(fmt_data) {
-        dw.insert(dw.end(),data.begin(),data.end());
         // swap endianness
-        std::deque<uint32_t>::iterator it;
-        for(it = dw.begin()+fmt_size;it != dw.end();it++) {
-            uint32_t ds = *it;
-            *it = ((ds & 0x000000FF) << 24) |
-                  ((ds & 0x0000FF00) <<  8) |
-                  ((ds & 0x00FF0000) >>  8) |
-                  ((ds & 0xFF000000) >> 24);
-        }
+        p = std::transform(data.begin(),data.end(),p,swap_endian);
     }
 
     // ** digest
     if(td) {
         // TODO: endianness of digest may be wrong
-        dw.push_back(digest);
+        *p++            = digest;
     }
+
+    assert(p == dw.begin()+n);
+    return n;
 }
 
 ostream& dlsc::pcie::operator << ( ostream &os, const pcie_tlp &tlp ) {
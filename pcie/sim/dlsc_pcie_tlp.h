@@ -5,6 +5,8 @@
 #include <iostream>
 #include <string>
 #include <deque>
+#include <algorithm>
+#include <stdexcept>
 #include <stdint.h>
 
 namespace dlsc {
@@ -40,6 +42,91 @@ enum pcie_cpl {
     CPL_CA              = 0x4
 };
 
+// non-owning view of contiguous dwords; the encode/decode functions work on
+// these, so TLPs can move to and from whatever buffer the caller has
+template <typename T>
+class pcie_span {
+public:
+    pcie_span() : ptr(0), len(0) { }
+    pcie_span(T *p, unsigned int n) : ptr(p), len(n) { }
+    template <typename U>
+    pcie_span(const pcie_span<U> &s) : ptr(s.begin()), len(s.size()) { }
+
+    inline T *begin() const { return ptr; }
+    inline T *end() const { return ptr+len; }
+    inline unsigned int size() const { return len; }
+    inline bool empty() const { return len == 0; }
+    inline T &operator[](unsigned int i) const { return ptr[i]; }
+
+private:
+    T               *ptr;
+    unsigned int    len;
+};
+
+typedef pcie_span<uint32_t>         pcie_dw_span;
+typedef pcie_span<const uint32_t>   pcie_const_dw_span;
+
+// TLP payload; fixed-capacity and contiguous, stored inline in the pcie_tlp so
+// building or decoding a TLP doesn't allocate. Copies only copy the words in
+// use. Supports the subset of std::deque that the models use.
+class pcie_tlp_payload {
+public:
+    enum { capacity = 1024 };   // maximum TLP payload, in dwords
+
+    typedef uint32_t        value_type;
+    typedef uint32_t        *iterator;
+    typedef const uint32_t  *const_iterator;
+
+    pcie_tlp_payload() : len(0) { }
+    pcie_tlp_payload(const pcie_tlp_payload &p) : len(p.len) { std::copy(p.buf,p.buf+len,buf); }
+    pcie_tlp_payload &operator=(const pcie_tlp_payload &p) {
+        len = p.len;
+        std::copy(p.buf,p.buf+len,buf);
+        return *this;
+    }
+
+    inline unsigned int size() const { return len; }
+    inline bool empty() const { return len == 0; }
+
+    inline iterator begin() { return buf; }
+    inline iterator end() { return buf+len; }
+    inline const_iterator begin() const { return buf; }
+    inline const_iterator end() const { return buf+len; }
+
+    inline uint32_t &operator[](unsigned int i) { return buf[i]; }
+    inline const uint32_t &operator[](unsigned int i) const { return buf[i]; }
+    inline const uint32_t &at(unsigned int i) const {
+        if(i >= len) throw std::out_of_range("pcie_tlp_payload");
+        return buf[i];
+    }
+
+    inline pcie_dw_span span() { return pcie_dw_span(buf,len); }
+    inline pcie_const_dw_span span() const { return pcie_const_dw_span(buf,len); }
+
+    inline void clear() { len = 0; }
+    inline void resize(unsigned int n) {
+        if(n > capacity) throw std::length_error("pcie_tlp_payload");
+        if(n > len) std::fill(buf+len,buf+n,0);
+        len = n;
+    }
+    inline void push_back(uint32_t d) {
+        if(len == capacity) throw std::length_error("pcie_tlp_payload");
+        buf[len++] = d;
+    }
+    template <class InputIterator>
+    void assign(InputIterator first, InputIterator last) {
+        len = 0;
+        for(;first != last;++first) push_back(*first);
+    }
+
+    inline bool operator==(const pcie_tlp_payload &p) const { return len == p.len && std::equal(buf,buf+len,p.buf); }
+    inline bool operator!=(const pcie_tlp_payload &p) const { return !(*this == p); }
+
+private:
+    unsigned int    len;
+    uint32_t        buf[capacity];
+};
+
 class pcie_tlp {
 
 public:
@@ -90,7 +177,7 @@ public:
     unsigned int    cfg_reg;    // [11:2]
 
     // ** payload
-    std::deque<uint32_t> data;
+    pcie_tlp_payload data;
     uint32_t        digest;
 
     // decoded fields
@@ -113,6 +200,14 @@ public:
 
     inline unsigned int size() const { return length; }
 
+    // largest serialized TLP: 4DW header, maximum payload and digest
+    enum { max_dw = 4 + pcie_tlp_payload::capacity + 1 };
+
+    // dwords that serialize will produce
+    inline unsigned int wire_size() const {
+        return (fmt_4dw ? 4 : 3) + (fmt_data ? data.size() : 0) + (td ? 1 : 0);
+    }
+
 public:
     pcie_tlp();
     pcie_tlp(const char *nm);
@@ -141,9 +236,16 @@ public:
     void set_byte_enables(unsigned int first, unsigned int last);
     void set_address(uint64_t address);
     void set_destination(unsigned int id);
+    void set_data(pcie_const_dw_span dw);
     void set_data(const std::deque<uint32_t> &dw);
 
+    // decodes a complete TLP from dw
+    bool deserialize(pcie_const_dw_span dw);
     bool deserialize(const std::deque<uint32_t> &dw);
+    // encodes into dw (which must hold at least wire_size() dwords); returns
+    // the number of dwords written
+    unsigned int serialize(pcie_dw_span dw) const;
+    // appends to dw
     void serialize(std::deque<uint32_t> &dw) const;
 
     bool validate() const;
@@ -8,6 +8,11 @@
 #include <tlm_utils/multi_passthrough_target_socket.h>
 #include <tlm_utils/multi_passthrough_initiator_socket.h>
 
+#include <vector>
+
+#include "dlsc_random.h"
+#include "dlsc_tlm_recorder.h"
+
 template <typename DATATYPE = uint32_t>
 class dlsc_tlm_channel : public sc_core::sc_module {
 public:
@@ -17,8 +22,11 @@ public:
     typedef tlm_utils::multi_passthrough_target_socket<dlsc_tlm_channel<DATATYPE>,sizeof(DATATYPE)*8,tlm::tlm_base_protocol_types> t_socket_type;
     t_socket_type in_socket;
     
-    // callback
+    // callbacks
     virtual tlm::tlm_sync_enum nb_transport_fw(int id, tlm::tlm_generic_payload &trans, tlm::tlm_phase &phase, sc_core::sc_time &delay);
+    virtual void b_transport(int id, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay);
+    virtual unsigned int transport_dbg(int id, tlm::tlm_generic_payload &trans);
+    virtual bool get_direct_mem_ptr(int id, tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data);
 
 
     // ** initiator socket **
@@ -26,8 +34,9 @@ public:
     typedef tlm_utils::multi_passthrough_initiator_socket<dlsc_tlm_channel<DATATYPE>,sizeof(DATATYPE)*8,tlm::tlm_base_protocol_types> i_socket_type;
     i_socket_type out_socket;
     
-    // callback
+    // callbacks
     virtual tlm::tlm_sync_enum nb_transport_bw(int id, tlm::tlm_generic_payload &trans, tlm::tlm_phase &phase, sc_core::sc_time &delay);
+    virtual void invalidate_direct_mem_ptr(int id, sc_dt::uint64 start_range, sc_dt::uint64 end_range);
 
 
     // ** functions **
@@ -45,21 +54,39 @@ public:
         set_request_delay(delay_min,delay_max);
         set_response_delay(delay_min,delay_max);
     }
+
+    // link model (in addition to the random delays above); bytes_per_ns of 0 is unlimited
+    // bandwidth; write data is serialized on the request path, read data on the response path;
+    // max_inflight of 0 is unlimited (only enforced when remove_annotation is set)
+    void set_bandwidth(const double bytes_per_ns, const unsigned int max_inflight = 0);
+
+    // passes DMI requests (and invalidations) through to the target; off by default, since
+    // DMI accesses bypass the random delays and link model entirely
+    void set_dmi(const bool enable) { dmi_enabled = enable; }
+
+    // logs every transaction accepted on in_socket (not owned)
+    void set_recorder(dlsc_tlm_recorder *recorder) { this->recorder = recorder; }
     
     void end_of_elaboration();
+    void end_of_simulation();
+
+    ~dlsc_tlm_channel();
     
     SC_HAS_PROCESS(dlsc_tlm_channel);
 
 private:
 
     struct queue_entry {
-        queue_entry(tlm::tlm_generic_payload *t) : trans(t) { assert(trans); trans->acquire(); }
-        ~queue_entry() { trans->release(); }
         int                         socket;
         tlm::tlm_phase              phase;
-        tlm::tlm_generic_payload * const trans; // const pointer to non-const trans
+        tlm::tlm_generic_payload    *trans;
     };
 
+    // entries are recycled rather than allocated per hop
+    std::vector<queue_entry*> qe_pool;
+    queue_entry *qe_alloc(tlm::tlm_generic_payload *trans, const int socket, const tlm::tlm_phase phase);
+    void qe_free(queue_entry *qe);
+
     bool fw_outstanding;
     void fw_queue_method();
     sc_core::sc_event fw_event;
@@ -80,7 +107,55 @@ private:
     sc_core::sc_time fw_next_delay;
     sc_core::sc_time bw_next_delay;
 
+    dlsc_random_stream rng;
+
+    dlsc_tlm_recorder *recorder;
+
+    // start of each recorded transaction, carried in the payload
+    struct record_extension;
+    void record_begin(tlm::tlm_generic_payload &trans, const int socket, const sc_core::sc_time &t);
+    void record_end(tlm::tlm_generic_payload &trans, const sc_core::sc_time &t);
+
+    bool dmi_enabled;
+
     sc_core::sc_time rand_delay(const sc_core::sc_time &min, const sc_core::sc_time &max, sc_core::sc_time &next);
+
+    // link model
+    double              link_bytes_per_ns;
+    unsigned int        link_max_inflight;
+    unsigned int        link_inflight;
+    sc_core::sc_time    fw_link_free;
+    sc_core::sc_time    bw_link_free;
+
+    sc_core::sc_time link_delay(const unsigned int bytes, const sc_core::sc_time &delay, sc_core::sc_time &link_free);
+    // 'data' is set for the phase that carries the payload across the link
+    // (BEGIN_REQ for writes, BEGIN_RESP for reads); other phases only get the
+    // random delay, so data isn't charged to the link twice
+    inline sc_core::sc_time fw_delay(const tlm::tlm_generic_payload &trans, const sc_core::sc_time &delay, const bool data) {
+        sc_core::sc_time d = rand_delay(fw_min_delay,fw_max_delay,fw_next_delay);
+        if(!data || !trans.is_write()) return d;
+        return d + link_delay(trans.get_data_length(),delay+d,fw_link_free);
+    }
+    inline sc_core::sc_time bw_delay(const tlm::tlm_generic_payload &trans, const sc_core::sc_time &delay, const bool data) {
+        sc_core::sc_time d = rand_delay(bw_min_delay,bw_max_delay,bw_next_delay);
+        if(!data || !trans.is_read()) return d;
+        return d + link_delay(trans.get_data_length(),delay+d,bw_link_free);
+    }
+};
+
+// entries are kept in a vector so a payload can pass through multiple channels; the
+// extension stays attached across payload reuse, so its storage is recycled too
+template <typename DATATYPE>
+struct dlsc_tlm_channel<DATATYPE>::record_extension : public tlm::tlm_extension<record_extension> {
+    struct entry {
+        const dlsc_tlm_channel<DATATYPE>    *channel;
+        sc_core::sc_time                    begin;
+        uint64_t                            addr;
+        int                                 socket;
+    };
+    tlm::tlm_extension_base *clone() const { record_extension *ext = new record_extension; ext->entries = entries; return ext; }
+    void copy_from(const tlm::tlm_extension_base &ext) { entries = static_cast<const record_extension&>(ext).entries; }
+    std::vector<entry> entries;
 };
 
 // constructor
@@ -93,10 +168,15 @@ dlsc_tlm_channel<DATATYPE>::dlsc_tlm_channel(
     sc_module(nm),
     fw_queue("fw_queue"),
     bw_queue("bw_queue"),
-    rm_ann(remove_annotation)
+    rm_ann(remove_annotation),
+    rng(this->name())
 {
     in_socket.register_nb_transport_fw(this,&dlsc_tlm_channel<DATATYPE>::nb_transport_fw);
+    in_socket.register_b_transport(this,&dlsc_tlm_channel<DATATYPE>::b_transport);
+    in_socket.register_transport_dbg(this,&dlsc_tlm_channel<DATATYPE>::transport_dbg);
+    in_socket.register_get_direct_mem_ptr(this,&dlsc_tlm_channel<DATATYPE>::get_direct_mem_ptr);
     out_socket.register_nb_transport_bw(this,&dlsc_tlm_channel<DATATYPE>::nb_transport_bw);
+    out_socket.register_invalidate_direct_mem_ptr(this,&dlsc_tlm_channel<DATATYPE>::invalidate_direct_mem_ptr);
 
     sc_core::sc_time min_delay = sc_core::sc_time(10 ,SC_NS);
     sc_core::sc_time max_delay = sc_core::sc_time(100,SC_NS);
@@ -110,6 +190,16 @@ dlsc_tlm_channel<DATATYPE>::dlsc_tlm_channel(
     fw_outstanding  = false;
     bw_outstanding  = false;
 
+    link_bytes_per_ns   = 0.0;
+    link_max_inflight   = 0;
+    link_inflight       = 0;
+    fw_link_free        = sc_core::SC_ZERO_TIME;
+    bw_link_free        = sc_core::SC_ZERO_TIME;
+
+    recorder            = NULL;
+
+    dmi_enabled         = false;
+
     SC_METHOD(fw_queue_method);
         sensitive << fw_queue.get_event();
         sensitive << fw_event;
@@ -119,10 +209,65 @@ dlsc_tlm_channel<DATATYPE>::dlsc_tlm_channel(
         sensitive << bw_event;
 }
 
+template <typename DATATYPE>
+dlsc_tlm_channel<DATATYPE>::~dlsc_tlm_channel() {
+    for(unsigned int i=0;i<qe_pool.size();++i) {
+        delete qe_pool[i];
+    }
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_channel<DATATYPE>::end_of_elaboration() {
     assert(in_socket.size() == out_socket.size());
+    if(link_max_inflight && !rm_ann) {
+        dlsc_info("max in-flight limit is only enforced with remove_annotation; ignoring");
+    }
 }
+
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::end_of_simulation() {
+    if(recorder) {
+        recorder->flush();
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::record_begin(
+    tlm::tlm_generic_payload &trans,
+    const int socket,
+    const sc_core::sc_time &t
+) {
+    record_extension *ext;
+    trans.get_extension(ext);
+    if(!ext) {
+        ext = new record_extension;
+        trans.set_extension(ext);
+    }
+    ext->entries.resize(ext->entries.size()+1);
+    typename record_extension::entry &e = ext->entries.back();
+    e.channel   = this;
+    e.begin     = t;
+    e.addr      = trans.get_address();
+    e.socket    = socket;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::record_end(
+    tlm::tlm_generic_payload &trans,
+    const sc_core::sc_time &t
+) {
+    record_extension *ext;
+    trans.get_extension(ext);
+    if(!ext) return;    // begun before the recorder was attached
+    for(typename std::vector<typename record_extension::entry>::iterator it = ext->entries.begin(); it != ext->entries.end(); ++it) {
+        if(it->channel == this) {
+            recorder->record(it->begin,t,trans,it->socket,-1,it->addr);
+            ext->entries.erase(it);
+            return;
+        }
+    }
+}
+
     
 // configuration
 
@@ -146,13 +291,69 @@ void dlsc_tlm_channel<DATATYPE>::set_response_delay(
     bw_max_delay    = delay_max;
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::set_bandwidth(
+    const double bytes_per_ns,
+    const unsigned int max_inflight
+) {
+    assert(bytes_per_ns >= 0.0);
+    link_bytes_per_ns   = bytes_per_ns;
+    link_max_inflight   = max_inflight;
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_channel<DATATYPE>::queue_entry *dlsc_tlm_channel<DATATYPE>::qe_alloc(
+    tlm::tlm_generic_payload *trans,
+    const int socket,
+    const tlm::tlm_phase phase
+) {
+    assert(trans);
+    queue_entry *qe;
+    if(qe_pool.empty()) {
+        qe = new queue_entry;
+    } else {
+        qe = qe_pool.back();
+        qe_pool.pop_back();
+    }
+    trans->acquire();
+    qe->trans   = trans;
+    qe->socket  = socket;
+    qe->phase   = phase;
+    return qe;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::qe_free(queue_entry *qe) {
+    qe->trans->release();
+    qe->trans   = NULL;
+    qe_pool.push_back(qe);
+}
+
+template <typename DATATYPE>
+sc_core::sc_time dlsc_tlm_channel<DATATYPE>::link_delay(
+    const unsigned int bytes,
+    const sc_core::sc_time &delay,
+    sc_core::sc_time &link_free
+) {
+    if(link_bytes_per_ns == 0.0 || bytes == 0) {
+        return sc_core::SC_ZERO_TIME;
+    }
+
+    // data occupies the link after any earlier data has gone by
+    const sc_core::sc_time arrive = sc_core::sc_time_stamp() + delay;
+    sc_core::sc_time start = (link_free > arrive) ? link_free : arrive;
+    link_free = start + sc_core::sc_time(bytes / link_bytes_per_ns,sc_core::SC_NS);
+
+    return link_free - arrive;
+}
+
 template <typename DATATYPE>
 sc_core::sc_time dlsc_tlm_channel<DATATYPE>::rand_delay(
     const sc_core::sc_time &min,
     const sc_core::sc_time &max,
     sc_core::sc_time &next
 ) {
-    float scale = ((rand()%1000)/1000.0f);
+    float scale = rng.rand<float>(0.0f,1.0f);
     sc_core::sc_time delay = min + ((max-min) * scale);
     if(next >= (delay+sc_core::sc_time_stamp())) {
         // don't allow new transaction to pass old ones
@@ -174,11 +375,18 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_fw(
 ) {
     assert(phase != tlm::END_REQ && phase != tlm::BEGIN_RESP);
 
+    if(recorder && phase == tlm::BEGIN_REQ) {
+        record_begin(trans,id,sc_core::sc_time_stamp() + delay);
+    }
+
     // copy delay value; don't want to advance initiator's time until request is completed
     sc_core::sc_time delay_i = delay;
 
+    // only a new request carries data (or gets a response that does)
+    const bool request = (phase == tlm::BEGIN_REQ);
+
     // request prop delay
-    delay_i += rand_delay(fw_min_delay,fw_max_delay,fw_next_delay);
+    delay_i += fw_delay(trans,delay_i,request);
 
     if(rm_ann) {
         // ** no timing annotation **
@@ -190,9 +398,7 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_fw(
             return tlm::TLM_COMPLETED;
         } else if(phase == tlm::BEGIN_REQ) {
             // must schedule forward call for the future
-            queue_entry *qe = new queue_entry(&trans);
-            qe->socket  = id;
-            qe->phase   = phase;
+            queue_entry *qe = qe_alloc(&trans,id,phase);
             fw_queue.notify(*qe,delay_i);
             phase       = tlm::END_REQ;
             return tlm::TLM_UPDATED;
@@ -207,10 +413,14 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_fw(
 
         if(phase == tlm::BEGIN_RESP || status == tlm::TLM_COMPLETED) {
             // completed; apply response delay as well
-            delay_i += rand_delay(bw_min_delay,bw_max_delay,bw_next_delay);
+            delay_i += bw_delay(trans,delay_i,request);
 
             // can complete now
             delay   = delay_i;
+
+            if(recorder) {
+                record_end(trans,sc_core::sc_time_stamp() + delay);
+            }
         }
         
         return status;
@@ -219,27 +429,81 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_fw(
     assert(false);
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::b_transport(
+    int id,
+    tlm::tlm_generic_payload &trans,
+    sc_core::sc_time &delay
+) {
+    // always annotated (remove_annotation only applies to nb_transport)
+    sc_core::sc_time start = sc_core::sc_time_stamp() + delay;
+    delay += fw_delay(trans,delay,true);
+    out_socket[id]->b_transport(trans,delay);
+    delay += bw_delay(trans,delay,true);
+
+    if(recorder) {
+        recorder->record(start,sc_core::sc_time_stamp() + delay,trans,id);
+    }
+}
+
+template <typename DATATYPE>
+unsigned int dlsc_tlm_channel<DATATYPE>::transport_dbg(
+    int id,
+    tlm::tlm_generic_payload &trans
+) {
+    return out_socket[id]->transport_dbg(trans);
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_channel<DATATYPE>::get_direct_mem_ptr(
+    int id,
+    tlm::tlm_generic_payload &trans,
+    tlm::tlm_dmi &dmi_data
+) {
+    if(!dmi_enabled) {
+        // refused for the whole address space
+        dmi_data.allow_none();
+        dmi_data.set_start_address(0);
+        dmi_data.set_end_address((sc_dt::uint64)-1);
+        return false;
+    }
+    return out_socket[id]->get_direct_mem_ptr(trans,dmi_data);
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_channel<DATATYPE>::invalidate_direct_mem_ptr(
+    int id,
+    sc_dt::uint64 start_range,
+    sc_dt::uint64 end_range
+) {
+    in_socket[id]->invalidate_direct_mem_ptr(start_range,end_range);
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_channel<DATATYPE>::fw_queue_method() {
     queue_entry *qe;
-    while( !fw_outstanding && (qe = fw_queue.get_next_transaction()) ) {
+    while( !fw_outstanding && (!link_max_inflight || link_inflight < link_max_inflight) && (qe = fw_queue.get_next_transaction()) ) {
         sc_core::sc_time delay      = sc_core::SC_ZERO_TIME;
         sc_core::sc_time delay_i    = sc_core::SC_ZERO_TIME;
         int id                      = qe->socket;
         tlm::tlm_generic_payload &trans = *(qe->trans);
         tlm::tlm_phase phase        = qe->phase;
-        delete qe;
+
+        // keep payload alive until we're done with it below
+        trans.acquire();
+        qe_free(qe);
+
+        // credit returned when response is delivered (bw_queue_method)
+        link_inflight++;
         
         tlm::tlm_sync_enum status = out_socket[id]->nb_transport_fw(trans,phase,delay);
 
         if(phase == tlm::BEGIN_RESP || status == tlm::TLM_COMPLETED) {
             // completed; apply response delay as well
-            delay_i     = delay + rand_delay(bw_min_delay,bw_max_delay,bw_next_delay);
+            delay_i     = delay + bw_delay(trans,delay,true);
 
             // must schedule a completion notification for the future
-            qe          = new queue_entry(&trans);
-            qe->socket  = id;
-            qe->phase   = tlm::BEGIN_RESP;
+            qe          = qe_alloc(&trans,id,tlm::BEGIN_RESP);
             bw_queue.notify(*qe,delay_i);
 
             if(phase == tlm::BEGIN_RESP && status != tlm::TLM_COMPLETED) {
@@ -251,6 +515,8 @@ void dlsc_tlm_channel<DATATYPE>::fw_queue_method() {
             // blocked
             fw_outstanding = true;
         }
+
+        trans.release();
     }
 }
 
@@ -270,7 +536,7 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_bw(
     sc_core::sc_time delay_i = delay;
 
     // response prop delay
-    delay_i += rand_delay(bw_min_delay,bw_max_delay,bw_next_delay);
+    delay_i += bw_delay(trans,delay_i,phase == tlm::BEGIN_RESP);
 
     if(rm_ann) {
         // ** no timing annotation **
@@ -284,9 +550,7 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_bw(
             return tlm::TLM_ACCEPTED;
         } else if(phase == tlm::BEGIN_RESP) {
             // must schedule backward call for the future
-            queue_entry *qe = new queue_entry(&trans);
-            qe->socket  = id;
-            qe->phase   = phase;
+            queue_entry *qe = qe_alloc(&trans,id,phase);
             bw_queue.notify(*qe,delay_i);
             phase       = tlm::END_RESP;
             return tlm::TLM_COMPLETED;
@@ -296,6 +560,9 @@ tlm::tlm_sync_enum dlsc_tlm_channel<DATATYPE>::nb_transport_bw(
         }
     } else {
         // ** with timing annotation **
+        if(recorder && phase == tlm::BEGIN_RESP) {
+            record_end(trans,sc_core::sc_time_stamp() + delay_i);
+        }
         // can send immediately
         return in_socket[id]->nb_transport_bw(trans,phase,delay_i);
     }
@@ -308,11 +575,19 @@ void dlsc_tlm_channel<DATATYPE>::bw_queue_method() {
     queue_entry *qe;
     while( !bw_outstanding && (qe = bw_queue.get_next_transaction()) ) {
         sc_core::sc_time delay_i    = sc_core::SC_ZERO_TIME;
+        if(qe->phase == tlm::BEGIN_RESP && link_inflight > 0) {
+            // return credit
+            link_inflight--;
+            fw_event.notify();
+        }
+        if(recorder && qe->phase == tlm::BEGIN_RESP) {
+            record_end(*(qe->trans),sc_core::sc_time_stamp());
+        }
         if(in_socket[qe->socket]->nb_transport_bw(*(qe->trans),qe->phase,delay_i) != tlm::TLM_COMPLETED && qe->phase == tlm::BEGIN_RESP) {
             // blocked
             bw_outstanding = true;
         }
-        delete qe;
+        qe_free(qe);
     }
 }
 
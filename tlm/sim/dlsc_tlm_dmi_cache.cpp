@@ -0,0 +1,70 @@
+
+#include <cassert>
+#include <algorithm>
+#include "dlsc_tlm_dmi_cache.h"
+
+dlsc_tlm_dmi_cache::dlsc_tlm_dmi_cache() {
+    hint    = false;
+    hits    = 0;
+    misses  = 0;
+}
+
+uint8_t *dlsc_tlm_dmi_cache::lookup(const uint64_t addr, const unsigned int lengthb, const bool write, sc_core::sc_time &latency) {
+    const uint64_t addr_last = addr + lengthb - 1;
+
+    for(std::vector<tlm::tlm_dmi>::iterator it = regions.begin(); it != regions.end(); ++it) {
+        if(addr < (*it).get_start_address() || addr_last > (*it).get_end_address()) {
+            continue;
+        }
+        if(write ? !(*it).is_write_allowed() : !(*it).is_read_allowed()) {
+            continue;
+        }
+
+        // move to front; accesses tend to stay within one region
+        if(it != regions.begin()) {
+            std::iter_swap(it,regions.begin());
+            it = regions.begin();
+        }
+
+        hits++;
+        latency = write ? (*it).get_write_latency() : (*it).get_read_latency();
+        return (*it).get_dmi_ptr() + (addr - (*it).get_start_address());
+    }
+
+    misses++;
+    return NULL;
+}
+
+void dlsc_tlm_dmi_cache::insert(const tlm::tlm_dmi &dmi_data) {
+    assert(dmi_data.get_dmi_ptr() && dmi_data.get_start_address() <= dmi_data.get_end_address());
+
+    // replace anything the new region overlaps (it is the target's latest word on that range)
+    invalidate(dmi_data.get_start_address(),dmi_data.get_end_address());
+
+    regions.insert(regions.begin(),dmi_data);
+}
+
+void dlsc_tlm_dmi_cache::invalidate(const uint64_t start, const uint64_t end) {
+    std::vector<tlm::tlm_dmi>::iterator it = regions.begin();
+    while(it != regions.end()) {
+        if(start <= (*it).get_end_address() && end >= (*it).get_start_address()) {
+            it = regions.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void dlsc_tlm_dmi_cache::clear() {
+    regions.clear();
+}
+
+void dlsc_tlm_dmi_cache::report(std::ostream &os) const {
+    os << std::dec << "DMI hits: " << hits << ", misses: " << misses << ", regions: " << regions.size();
+}
+
+std::ostream& operator << ( std::ostream &os, const dlsc_tlm_dmi_cache &cache ) {
+    cache.report(os);
+    return os;
+}
+
@@ -0,0 +1,45 @@
+
+#ifndef DLSC_TLM_DMI_CACHE_H_INCLUDED
+#define DLSC_TLM_DMI_CACHE_H_INCLUDED
+
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+#include <tlm.h>
+
+// caches DMI regions granted by a single target; used by initiators to bypass
+// the transport interface for backdoor-eligible accesses
+class dlsc_tlm_dmi_cache {
+public:
+    dlsc_tlm_dmi_cache();
+
+    // returns a pointer to addr if [addr,addr+lengthb) is entirely within a cached
+    // region that grants the requested access; sets latency to that region's latency
+    uint8_t *lookup(const uint64_t addr, const unsigned int lengthb, const bool write, sc_core::sc_time &latency);
+
+    void insert(const tlm::tlm_dmi &dmi_data);
+
+    // drops any region overlapping [start,end]
+    void invalidate(const uint64_t start, const uint64_t end);
+    void clear();
+
+    // target indicated DMI is worth asking for (via tlm_generic_payload::is_dmi_allowed)
+    inline void set_hint(const bool hint) { this->hint = hint; }
+    inline bool get_hint() const { return hint; }
+
+    // statistics
+    inline uint64_t get_hits() const { return hits; }
+    inline uint64_t get_misses() const { return misses; }
+    void report(std::ostream &os) const;
+
+private:
+    std::vector<tlm::tlm_dmi> regions;     // most recently used first
+    bool hint;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+std::ostream& operator << ( std::ostream &os, const dlsc_tlm_dmi_cache &cache );
+
+#endif
+
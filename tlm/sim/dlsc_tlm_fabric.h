@@ -8,7 +8,10 @@
 #include <tlm_utils/multi_passthrough_initiator_socket.h>
 
 #include <vector>
-#include <map>
+#include <algorithm>
+
+#include "dlsc_common.h"
+#include "dlsc_tlm_recorder.h"
 
 template <typename DATATYPE = uint32_t>
 class dlsc_tlm_fabric : public sc_core::sc_module {
@@ -19,8 +22,10 @@ public:
     typedef tlm_utils::multi_passthrough_target_socket<dlsc_tlm_fabric<DATATYPE>,sizeof(DATATYPE)*8,tlm::tlm_base_protocol_types> t_socket_type;
     t_socket_type in_socket;
     
-    // callback
+    // callbacks
     virtual tlm::tlm_sync_enum nb_transport_fw(int id, tlm::tlm_generic_payload &trans, tlm::tlm_phase &phase, sc_core::sc_time &delay);
+    virtual void b_transport(int id, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay);
+    virtual unsigned int transport_dbg(int id, tlm::tlm_generic_payload &trans);
 
 
     // ** initiator socket **
@@ -52,6 +57,13 @@ public:
     void set_write_okay(const int socket, const bool write_okay);
     
     void end_of_elaboration();
+    void end_of_simulation();
+
+    // per-socket statistics
+    void report();
+
+    // logs every transaction accepted on in_socket (not owned)
+    void set_recorder(dlsc_tlm_recorder *recorder) { this->recorder = recorder; }
 
 private:
 
@@ -59,7 +71,42 @@ private:
 
     std::vector<fabric_map> maps;
 
-    std::map<tlm::tlm_generic_payload*,int> outstanding;
+    // decode table; maps are aligned power-of-2 regions, so the address space splits into
+    // disjoint segments that each resolve to one socket for reads and one for writes
+    struct decode_entry {
+        int read_socket;
+        int write_socket;
+    };
+
+    bool                        decode_dirty;
+    std::vector<uint64_t>       decode_start;       // sorted; first is always 0
+    std::vector<decode_entry>   decode_entries;
+
+    void decode_build();
+    int decode(const tlm::tlm_generic_payload &trans);
+
+    // route through this fabric is recorded in the payload itself
+    struct route_extension;
+    struct route_hop;
+    route_hop *route_push(tlm::tlm_generic_payload &trans);     // (pointers are invalidated by later pushes)
+    route_hop *route_find(tlm::tlm_generic_payload &trans);
+    void route_pop(tlm::tlm_generic_payload &trans);
+    void route_respond(route_hop *hop, const tlm::tlm_generic_payload &trans, const sc_core::sc_time &delay);
+
+    dlsc_tlm_recorder           *recorder;
+
+    // statistics
+    struct port_stats {
+        port_stats() : transactions(0), bytes(0), errors(0), latency_cnt(0), latency_total(sc_core::SC_ZERO_TIME) {}
+        uint64_t            transactions;
+        uint64_t            bytes;
+        uint64_t            errors;             // decode errors (in sockets only)
+        uint64_t            latency_cnt;
+        sc_core::sc_time    latency_total;      // request to response
+    };
+
+    std::vector<port_stats>     in_stats;
+    std::vector<port_stats>     out_stats;
 };
 
 
@@ -83,6 +130,25 @@ struct dlsc_tlm_fabric<DATATYPE>::fabric_map {
     bool      write_okay;
 };
 
+template <typename DATATYPE>
+struct dlsc_tlm_fabric<DATATYPE>::route_hop {
+    const dlsc_tlm_fabric<DATATYPE> *fabric;
+    int                 in_id;
+    int                 out_id;
+    bool                responded;
+    sc_core::sc_time    start;
+    uint64_t            addr;               // prior to translation
+};
+
+// hops are kept in a vector so a payload can pass through multiple fabrics; the
+// extension stays attached across payload reuse, so its storage is recycled too
+template <typename DATATYPE>
+struct dlsc_tlm_fabric<DATATYPE>::route_extension : public tlm::tlm_extension<route_extension> {
+    tlm::tlm_extension_base *clone() const { route_extension *ext = new route_extension; ext->hops = hops; return ext; }
+    void copy_from(const tlm::tlm_extension_base &ext) { hops = static_cast<const route_extension&>(ext).hops; }
+    std::vector<route_hop> hops;
+};
+
 
 // constructor
 
@@ -93,7 +159,12 @@ dlsc_tlm_fabric<DATATYPE>::dlsc_tlm_fabric(
     sc_module(nm)
 {
     in_socket.register_nb_transport_fw(this,&dlsc_tlm_fabric<DATATYPE>::nb_transport_fw);
+    in_socket.register_b_transport(this,&dlsc_tlm_fabric<DATATYPE>::b_transport);
+    in_socket.register_transport_dbg(this,&dlsc_tlm_fabric<DATATYPE>::transport_dbg);
     out_socket.register_nb_transport_bw(this,&dlsc_tlm_fabric<DATATYPE>::nb_transport_bw);
+
+    decode_dirty = true;
+    recorder     = NULL;
 }
 
 template <typename DATATYPE>
@@ -101,6 +172,35 @@ void dlsc_tlm_fabric<DATATYPE>::end_of_elaboration() {
     if(maps.size() != out_socket.size()) {
         maps.resize(out_socket.size());
     }
+    decode_dirty = true;
+
+    in_stats.resize(in_socket.size());
+    out_stats.resize(out_socket.size());
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::end_of_simulation() {
+    report();
+    if(recorder) {
+        recorder->flush();
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::report() {
+    for(unsigned int j=0;j<2;++j) {
+        std::vector<port_stats> &stats = j ? out_stats : in_stats;
+        for(unsigned int i=0;i<stats.size();++i) {
+            const port_stats &st = stats[i];
+            if(!st.transactions) continue;
+            sc_core::sc_time avg = st.latency_cnt ? (st.latency_total / (double)st.latency_cnt) : sc_core::SC_ZERO_TIME;
+            if(j) {
+                dlsc_info("out_socket #" << std::dec << i << ": transactions: " << st.transactions << ", bytes: " << st.bytes << ", avg latency: " << avg);
+            } else {
+                dlsc_info("in_socket #" << std::dec << i << ": transactions: " << st.transactions << ", bytes: " << st.bytes << ", decode errors: " << st.errors << ", avg latency: " << avg);
+            }
+        }
+    }
 }
     
 // configuration
@@ -133,6 +233,8 @@ void dlsc_tlm_fabric<DATATYPE>::set_map(
     maps[socket].out_base   = out_base;
     maps[socket].read_okay  = read_okay;
     maps[socket].write_okay = write_okay;
+
+    decode_dirty = true;
 }
 
 template <typename DATATYPE>
@@ -145,6 +247,7 @@ void dlsc_tlm_fabric<DATATYPE>::set_read_okay(
         maps.resize(out_socket.size());
     }
     maps[socket].read_okay  = read_okay;
+    decode_dirty = true;
 }
 
 template <typename DATATYPE>
@@ -157,6 +260,127 @@ void dlsc_tlm_fabric<DATATYPE>::set_write_okay(
         maps.resize(out_socket.size());
     }
     maps[socket].write_okay  = write_okay;
+    decode_dirty = true;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::decode_build() {
+    // segment boundaries: start and end of every region
+    std::vector<uint64_t> bounds;
+    bounds.push_back(0);
+    for(unsigned int i=0;i<maps.size();++i) {
+        bounds.push_back(maps[i].in_base);
+        if( (maps[i].in_base | maps[i].in_mask) != 0xFFFFFFFFFFFFFFFF ) {
+            bounds.push_back( (maps[i].in_base | maps[i].in_mask) + 1 );
+        }
+    }
+    std::sort(bounds.begin(),bounds.end());
+    bounds.erase(std::unique(bounds.begin(),bounds.end()),bounds.end());
+
+    decode_start.clear();
+    decode_entries.clear();
+
+    for(unsigned int b=0;b<bounds.size();++b) {
+        // lowest-numbered matching socket wins (same as a linear scan)
+        decode_entry e = { -1, -1 };
+        for(int i=0;i<(int)maps.size();++i) {
+            if( (bounds[b] & ~maps[i].in_mask) != maps[i].in_base ) continue;
+            if(e.read_socket  < 0 && maps[i].read_okay ) e.read_socket  = i;
+            if(e.write_socket < 0 && maps[i].write_okay) e.write_socket = i;
+        }
+
+        // merge with previous segment if equivalent
+        if(!decode_entries.empty() && decode_entries.back().read_socket == e.read_socket && decode_entries.back().write_socket == e.write_socket) {
+            continue;
+        }
+
+        decode_start.push_back(bounds[b]);
+        decode_entries.push_back(e);
+    }
+
+    decode_dirty = false;
+}
+
+template <typename DATATYPE>
+int dlsc_tlm_fabric<DATATYPE>::decode(const tlm::tlm_generic_payload &trans) {
+    if(decode_dirty) {
+        decode_build();
+    }
+
+    const uint64_t addr = trans.get_address();
+
+    // last segment starting at or below addr
+    unsigned int i = (std::upper_bound(decode_start.begin(),decode_start.end(),addr) - decode_start.begin()) - 1;
+
+    if(trans.is_read())  return decode_entries[i].read_socket;
+    if(trans.is_write()) return decode_entries[i].write_socket;
+    return -1;
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_fabric<DATATYPE>::route_hop *dlsc_tlm_fabric<DATATYPE>::route_push(tlm::tlm_generic_payload &trans) {
+    route_extension *ext;
+    trans.get_extension(ext);
+    if(!ext) {
+        ext = new route_extension;
+        trans.set_extension(ext);
+    }
+
+    route_pop(trans);   // just in case a previous transaction left one behind
+
+    route_hop hop;
+    hop.fabric      = this;
+    hop.in_id       = -1;
+    hop.out_id      = -1;
+    hop.responded   = false;
+    ext->hops.push_back(hop);
+
+    return &ext->hops.back();
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_fabric<DATATYPE>::route_hop *dlsc_tlm_fabric<DATATYPE>::route_find(tlm::tlm_generic_payload &trans) {
+    route_extension *ext;
+    trans.get_extension(ext);
+    if(ext) {
+        for(typename std::vector<route_hop>::reverse_iterator it = ext->hops.rbegin(); it != ext->hops.rend(); ++it) {
+            if((*it).fabric == this) return &(*it);
+        }
+    }
+    return NULL;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::route_pop(tlm::tlm_generic_payload &trans) {
+    route_extension *ext;
+    trans.get_extension(ext);
+    if(!ext) return;
+    for(typename std::vector<route_hop>::iterator it = ext->hops.begin(); it != ext->hops.end(); ++it) {
+        if((*it).fabric == this) {
+            ext->hops.erase(it);
+            return;
+        }
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::route_respond(route_hop *hop, const tlm::tlm_generic_payload &trans, const sc_core::sc_time &delay) {
+    if(hop->responded) return;
+    hop->responded = true;
+
+    sc_core::sc_time end = sc_core::sc_time_stamp() + delay;
+    sc_core::sc_time latency = end - hop->start;
+
+    if(recorder) {
+        recorder->record(hop->start,end,trans,hop->in_id,hop->out_id,hop->addr);
+    }
+
+    in_stats[hop->in_id].latency_cnt++;
+    in_stats[hop->in_id].latency_total += latency;
+    if(hop->out_id >= 0) {
+        out_stats[hop->out_id].latency_cnt++;
+        out_stats[hop->out_id].latency_total += latency;
+    }
 }
 
 
@@ -172,17 +396,35 @@ tlm::tlm_sync_enum dlsc_tlm_fabric<DATATYPE>::nb_transport_fw(
     // copy delay value; don't want to advance initiator's time until request is completed
     sc_core::sc_time delay_i = delay;
 
-    // find destination socket
-    int socket = -1;
-    for(int i=0;i<(int)maps.size();++i) {
-        if( ((trans.get_address() & ~maps[i].in_mask) == maps[i].in_base) && 
-            ((trans.is_read() && maps[i].read_okay) || (trans.is_write() && maps[i].write_okay)) )
-        {
-            trans.set_address( (trans.get_address() & maps[i].out_mask) | maps[i].out_base );
+    route_hop *hop;
+    int socket;
+
+    if(phase == tlm::BEGIN_REQ) {
+        // find destination socket
+        socket          = decode(trans);
+
+        hop             = route_push(trans);
+        hop->in_id      = id;
+        hop->out_id     = socket;
+        hop->start      = sc_core::sc_time_stamp() + delay;
+        hop->addr       = trans.get_address();
 
-            socket = i;
-            break;
+        in_stats[id].transactions++;
+        in_stats[id].bytes += trans.get_data_length();
+
+        if(socket >= 0) {
+            out_stats[socket].transactions++;
+            out_stats[socket].bytes += trans.get_data_length();
+
+            trans.set_address( (trans.get_address() & maps[socket].out_mask) | maps[socket].out_base );
+        } else {
+            in_stats[id].errors++;
         }
+    } else {
+        // later phase of a transaction already routed
+        hop             = route_find(trans);
+        assert(hop && hop->in_id == id);
+        socket          = hop->out_id;
     }
 
     tlm::tlm_sync_enum status;
@@ -201,16 +443,76 @@ tlm::tlm_sync_enum dlsc_tlm_fabric<DATATYPE>::nb_transport_fw(
     if(phase == tlm::BEGIN_RESP || status == tlm::TLM_COMPLETED) {
         // completed; apply response delay as well
         delay   = delay_i;
-        outstanding.erase(&trans);   // just in case a previous call set this up
-    } else {
-        // track source socket
-        outstanding[&trans] = id;
+        // (look the hop up again; a downstream fabric may have added its own,
+        // reallocating the hops vector)
+        hop     = route_find(trans);
+        assert(hop);
+        route_respond(hop,trans,delay);
+        route_pop(trans);
     }
 
     return status;
 }
 
 
+template <typename DATATYPE>
+void dlsc_tlm_fabric<DATATYPE>::b_transport(
+    int id,
+    tlm::tlm_generic_payload &trans,
+    sc_core::sc_time &delay)
+{
+    int socket = decode(trans);
+    uint64_t addr = trans.get_address();
+
+    in_stats[id].transactions++;
+    in_stats[id].bytes += trans.get_data_length();
+
+    if(socket < 0) {
+        // no matching socket; generate a decode error
+        in_stats[id].errors++;
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        if(recorder) {
+            sc_core::sc_time t = sc_core::sc_time_stamp() + delay;
+            recorder->record(t,t,trans,id,-1,addr);
+        }
+        return;
+    }
+
+    out_stats[socket].transactions++;
+    out_stats[socket].bytes += trans.get_data_length();
+
+    trans.set_address( (trans.get_address() & maps[socket].out_mask) | maps[socket].out_base );
+
+    // target may wait, so measure in absolute (local) time
+    sc_core::sc_time start = sc_core::sc_time_stamp() + delay;
+    out_socket[socket]->b_transport(trans,delay);
+    sc_core::sc_time end = sc_core::sc_time_stamp() + delay;
+    sc_core::sc_time latency = end - start;
+
+    if(recorder) {
+        recorder->record(start,end,trans,id,socket,addr);
+    }
+
+    in_stats[id].latency_cnt++;
+    in_stats[id].latency_total += latency;
+    out_stats[socket].latency_cnt++;
+    out_stats[socket].latency_total += latency;
+}
+
+template <typename DATATYPE>
+unsigned int dlsc_tlm_fabric<DATATYPE>::transport_dbg(
+    int id,
+    tlm::tlm_generic_payload &trans)
+{
+    int socket = decode(trans);
+    if(socket < 0) {
+        return 0;
+    }
+    trans.set_address( (trans.get_address() & maps[socket].out_mask) | maps[socket].out_base );
+    return out_socket[socket]->transport_dbg(trans);
+}
+
+
 // ** initiator socket **
 
 template <typename DATATYPE>
@@ -224,7 +526,13 @@ tlm::tlm_sync_enum dlsc_tlm_fabric<DATATYPE>::nb_transport_bw(
     sc_core::sc_time delay_i = delay;
 
     // find source socket
-    int socket = outstanding[&trans];
+    route_hop *hop = route_find(trans);
+    assert(hop && hop->out_id == id);
+    int socket = hop->in_id;
+
+    if(phase == tlm::BEGIN_RESP) {
+        route_respond(hop,trans,delay);
+    }
 
     // send on its way
     assert(socket >= 0 && socket < (int)in_socket.size());
@@ -232,7 +540,7 @@ tlm::tlm_sync_enum dlsc_tlm_fabric<DATATYPE>::nb_transport_bw(
 
     if(phase == tlm::END_RESP || status == tlm::TLM_COMPLETED) {
         // cleanup
-        outstanding.erase(&trans);
+        route_pop(trans);
     }
 
     return status;
@@ -8,6 +8,8 @@
 #include <vector>
 #include <algorithm>
 
+#include "dlsc_tlm_dmi_cache.h"
+
 template <typename DATATYPE = uint32_t>
 class dlsc_tlm_initiator_b : public sc_core::sc_module {
 public:
@@ -29,6 +31,10 @@ public:
         
         dptr = new unsigned char[max_lengthb];
         b_payload->set_byte_enable_ptr(dptr);
+
+        dmi_enabled = false;
+
+        socket.register_invalidate_direct_mem_ptr(this,&dlsc_tlm_initiator_b<DATATYPE>::invalidate_direct_mem_ptr);
     }
 
     ~dlsc_tlm_initiator_b() {
@@ -36,6 +42,10 @@ public:
         delete b_payload->get_byte_enable_ptr();
         delete b_payload;
     }
+
+    // enables DMI fast path; accesses to a target that grants DMI become a direct copy
+    // plus the DMI latency (interpreted per-byte)
+    void set_dmi(const bool enable) { dmi_enabled = enable; }
    
     // *** Blocking Reads (annotated) ***
 
@@ -49,7 +59,13 @@ public:
         b_payload->set_data_length(lengthb);
         b_payload->set_byte_enable_length(0);
         b_payload->set_streaming_width(lengthb);
-        socket->b_transport(*b_payload,delay);
+        uint8_t *ptr = dmi_lookup(delay);
+        if(ptr) {
+            const DATATYPE *dptr = reinterpret_cast<const DATATYPE*>(ptr);
+            std::copy(dptr,dptr+length,first);
+            return true;
+        }
+        b_transport(delay);
         if(b_payload->get_response_status() == tlm::TLM_OK_RESPONSE) {
             DATATYPE *dptr = reinterpret_cast<DATATYPE*>(b_payload->get_data_ptr());
             std::copy(dptr,dptr+length,first);
@@ -88,8 +104,13 @@ public:
         b_payload->set_data_length(lengthb);
         b_payload->set_byte_enable_length(0);
         b_payload->set_streaming_width(lengthb);
+        uint8_t *ptr = dmi_lookup(delay);
+        if(ptr) {
+            std::copy(first,last,reinterpret_cast<DATATYPE*>(ptr));
+            return true;
+        }
         std::copy(first,last,reinterpret_cast<DATATYPE*>(b_payload->get_data_ptr()));
-        socket->b_transport(*b_payload,delay);
+        b_transport(delay);
         return (b_payload->get_response_status() == tlm::TLM_OK_RESPONSE);
     }
     
@@ -125,61 +146,53 @@ private:
     // blocking
     tlm::tlm_generic_payload *b_payload; // payload for use with blocking operations (class member to save alloc/dealloc time)
     
-//    // dmi
-//    struct dmi_range { uint64_t lower; uint64_t upper; tlm::tlm_dmi dmi_data; };
-//    bool                    dmi_read_possible;
-//    bool                    dmi_write_possible;
-//    std::vector<dmi_range>  dmi_read;
-//    std::vector<dmi_range>  dmi_write;
-//    inline bool dmi_can_read(const uint64_t addr, const unsigned int lengthb) { return dmi_can(addr,lengthb,dmi_read); }
-//    inline bool dmi_can_write(const uint64_t addr, const unsigned int lengthb) { return dmi_can(addr,lengthb,dmi_write); }
-//    
-//    bool dmi_can(const uint64_t addr, const unsigned int lengthb, std::vector<dmi_range> &dmi_vect) {
-//        const unsigned int addru = addr+lengthb;
-//        for(typename std::vector<dmi_range>::iterator it = dmi_vect.begin(); it != dmi_vect.end(); ++it) {
-//            if(addr >= (*it).lower && addru <= (*it).upper) { return true; }
-//        }
-//        return false;
-//    }
-//
-//    void dmi_set_read() {
-//        dmi_set(lower,upper,dmi_read);
-//        dmi_read_possible = true;
-//    }
-//
-//    void dmi_set_write() {
-//        dmi_set(lower,upper,dmi_write);
-//        dmi_write_possible = true;
-//    }
-//
-//    void dmi_set(tlm::tlm_dmi &dmi_data, std::vector<dmi_range> &dmi_vect) {
-//        for(typename std::vector<dmi_range>::iterator it = dmi_vect.begin(); it != dmi_vect.end(); ++it) {
-//            if( (lower >= (*it).lower && lower <= (*it).upper) ||
-//                (upper >= (*it).lower && upper <= (*it).upper) )
-//            {
-//                (*it).lower = std::min((*it).lower,lower);
-//                (*it).upper = std::max((*it).upper,upper);
-//                return;
-//            }
-//        }
-//        const dmi_range r = { lower, upper };
-//        dmi_vect.push_back(r);
-//    }
-//
-//    void dmi_clear(const uint64_t lower, const uint64_t upper) {
-//        dmi_clear(lower,upper,dmi_read);
-//        dmi_clear(lower,upper,dmi_write);
-//    }
-//
-//    void dmi_clear(const uint64_t lower, const uint64_t upper, std::vector<dmi_range> &dmi_vect) {
-//        for(typename std::vector<dmi_range>::iterator it = dmi_vect.begin(); it != dmi_vect.end(); ++it) {
-//            if( (lower >= (*it).lower && lower <= (*it).upper) ||
-//                (upper >= (*it).lower && upper <= (*it).upper) )
-//            {
-//                it = dmi_vect.erase(it);
-//            }
-//        }
-//    }
+    // dmi
+    bool                    dmi_enabled;
+    dlsc_tlm_dmi_cache      dmi_cache;
+
+    // performs b_payload through the socket, noting whether the target would grant DMI
+    void b_transport(sc_core::sc_time &delay) {
+        b_payload->set_dmi_allowed(false);
+        socket->b_transport(*b_payload,delay);
+        if(dmi_enabled && b_payload->is_dmi_allowed()) {
+            dmi_cache.set_hint(true);
+        }
+    }
+
+    // returns a pointer for direct access to b_payload's region (and annotates delay),
+    // or NULL if the access must go through the socket
+    uint8_t *dmi_lookup(sc_core::sc_time &delay) {
+        if(!dmi_enabled) return NULL;
+
+        const bool write            = b_payload->is_write();
+        const uint64_t addr         = b_payload->get_address();
+        const unsigned int lengthb  = b_payload->get_data_length();
+
+        sc_core::sc_time latency;
+        uint8_t *ptr = dmi_cache.lookup(addr,lengthb,write,latency);
+
+        if(!ptr && dmi_cache.get_hint()) {
+            tlm::tlm_dmi dmi_data;
+            if(socket->get_direct_mem_ptr(*b_payload,dmi_data) && dmi_data.get_dmi_ptr()) {
+                dmi_cache.insert(dmi_data);
+                ptr = dmi_cache.lookup(addr,lengthb,write,latency);
+            } else {
+                // don't ask again until target indicates otherwise
+                dmi_cache.set_hint(false);
+            }
+        }
+
+        if(ptr) {
+            b_payload->set_response_status(tlm::TLM_OK_RESPONSE);
+            delay += latency * lengthb;
+        }
+        return ptr;
+    }
+
+    // simple_initiator_socket callback
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {
+        dmi_cache.invalidate(start_range,end_range);
+    }
 
 };
 
@@ -9,12 +9,14 @@
 
 #include <vector>
 #include <deque>
-#include <map>
 #include <algorithm>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "dlsc_tlm_mm.h"
 #include "dlsc_tlm_utils.h"
+#include "dlsc_tlm_dmi_cache.h"
+#include "dlsc_tlm_recorder.h"
 
 #include "dlsc_common.h"
 
@@ -27,16 +29,36 @@ public:
     socket_type socket;
 
     class transaction_state;
-    typedef boost::shared_ptr<transaction_state> transaction;
+    typedef boost::intrusive_ptr<transaction_state> transaction;
+
+    class transfer_state;
+    typedef boost::shared_ptr<transfer_state> transfer;
 
     // constructor
     dlsc_tlm_initiator_nb(const sc_core::sc_module_name &nm, const unsigned int max_length = 16);
+    ~dlsc_tlm_initiator_nb();
     void end_of_elaboration();
+    void end_of_simulation();
     
     // sets socket to use for subsequent transactions
     void set_socket(int id);
     inline unsigned int get_socket_size() { return socket.size(); }
 
+    // enables DMI fast path; transactions to a target that grants DMI are satisfied with
+    // a direct copy (completing after the DMI latency, interpreted per-byte) whenever no
+    // earlier transaction is still outstanding
+    void set_dmi(const bool enable) { dmi_enabled = enable; }
+
+    // enables loosely-timed mode; transactions are issued with b_transport (whenever no
+    // earlier request is still waiting to be accepted) and complete immediately, with the
+    // target's annotated delay applied when waited on (use the annotated calls together
+    // with the global quantum for temporal decoupling); must be called from a thread, and
+    // every target must support b_transport
+    void set_lt(const bool enable) { lt_enabled = enable; }
+
+    // logs every completed transaction (not owned)
+    void set_recorder(dlsc_tlm_recorder *recorder) { this->recorder = recorder; }
+
     // *** Read ***
     transaction nb_read(
         const uint64_t addr,
@@ -101,12 +123,51 @@ public:
         return nb_write(addr,data.begin(),data.end(),strb.begin(),strb.end(),delay_initial);
     }
 
+    // *** Large transfers ***
+    // split into bursts of at most max_length words that don't cross a 4KB boundary;
+    // all bursts are launched immediately and complete through a single handle
+    transfer nb_read_transfer(
+        const uint64_t addr,
+        const unsigned int length,
+        sc_core::sc_time delay_initial = sc_core::SC_ZERO_TIME);
+
+    template <class InputIterator>
+    transfer nb_write_transfer(
+        const uint64_t addr,
+        InputIterator first,
+        const InputIterator last,
+        sc_core::sc_time delay_initial = sc_core::SC_ZERO_TIME);
+
+    inline transfer nb_write_transfer(
+        const uint64_t addr,
+        std::vector<DATATYPE> &data,
+        sc_core::sc_time delay_initial = sc_core::SC_ZERO_TIME)
+    {
+        return nb_write_transfer(addr,data.begin(),data.end(),delay_initial);
+    }
+
+    // zero-copy; payloads point straight into buf, which must stay valid (and, for
+    // writes, unmodified) until the transfer completes; buf isn't const for writes
+    // since targets are handed a plain data pointer
+    transfer nb_read_transfer(
+        const uint64_t addr,
+        DATATYPE *buf,
+        const unsigned int length,
+        sc_core::sc_time delay_initial = sc_core::SC_ZERO_TIME);
+
+    transfer nb_write_transfer(
+        const uint64_t addr,
+        DATATYPE *buf,
+        const unsigned int length,
+        sc_core::sc_time delay_initial = sc_core::SC_ZERO_TIME);
+
     // methods to wait for completions
     void wait();
     void wait(sc_core::sc_time &delay);
 
     // callback for simple_initiator_socket
     virtual tlm::tlm_sync_enum nb_transport_bw(int id,tlm::tlm_generic_payload &trans,tlm::tlm_phase &phase,sc_time &delay);
+    virtual void invalidate_direct_mem_ptr(int id,sc_dt::uint64 start_range,sc_dt::uint64 end_range);
     
     SC_HAS_PROCESS(dlsc_tlm_initiator_nb);
 
@@ -127,19 +188,63 @@ private:
 
     bool                        launch_outstanding;
     std::deque<transaction>     launch_queue;
-    std::map<tlm::tlm_generic_payload*,transaction> outstanding;
+
+    // transaction_state slot table; slots are allocated a slab at a time and
+    // recycled once the last reference to them is dropped
+    struct payload_extension;
+    const unsigned int                  ts_slab_size;
+    std::vector<transaction_state*>     ts_slabs;
+    std::vector<transaction_state*>     ts_pool;
+    transaction_state *ts_alloc();
+    void ts_free(transaction_state *ts);
+    transaction_state *ts_lookup(tlm::tlm_generic_payload &trans);
+
+    // launched but not yet completed transactions (intrusive list; each holds a reference)
+    transaction_state           *outstanding_head;
+    transaction_state           *outstanding_tail;
+    void outstanding_push(transaction_state *ts);
+    void outstanding_remove(transaction_state *ts);
 
     tlm_utils::peq_with_get<tlm::tlm_generic_payload> complete_queue;
 
+    // loosely-timed
+    bool                                lt_enabled;
+    sc_core::sc_time                    lt_done_time;       // latest completion time of any LT transaction
+    void complete_lt(transaction ts, sc_core::sc_time &delay);
+
+    dlsc_tlm_recorder                   *recorder;
+
+    // DMI
+    bool                                dmi_enabled;
+    std::vector<dlsc_tlm_dmi_cache>     dmi_caches;         // per-socket
+    bool dmi_transport(tlm::tlm_generic_payload *trans, sc_core::sc_time &delay);
+
     sc_core::sc_event           launch_event;
 
     transaction launch(tlm::tlm_generic_payload *trans, sc_core::sc_time &delay);
+    transaction launch_zero_copy(const tlm::tlm_command cmd, const uint64_t addr, uint8_t *ptr, const unsigned int lengthb, sc_core::sc_time delay);
+
+    // words that can go in one burst starting at addr
+    unsigned int burst_length(const uint64_t addr, const unsigned int remaining) const;
     void launch_update(sc_core::sc_time &delay);
     void launch_method();
 
     void complete_local(transaction ts, sc_core::sc_time &delay);
     void complete_final(transaction ts);
     void complete_method();
+
+    friend class transaction_state;
+    friend class transfer_state;
+};
+
+// associates a payload with the slot of the transaction it is currently carrying;
+// set once per payload and kept across reuse (payload pool never strips it)
+template <typename DATATYPE>
+struct dlsc_tlm_initiator_nb<DATATYPE>::payload_extension : public tlm::tlm_extension<payload_extension> {
+    payload_extension() : ts(0) {}
+    tlm::tlm_extension_base *clone() const { payload_extension *ext = new payload_extension; ext->ts = ts; return ext; }
+    void copy_from(const tlm::tlm_extension_base &ext) { ts = static_cast<const payload_extension&>(ext).ts; }
+    transaction_state *ts;
 };
    
 
@@ -155,13 +260,25 @@ dlsc_tlm_initiator_nb<DATATYPE>::dlsc_tlm_initiator_nb(
     bus_width(sizeof(DATATYPE)),
     max_length(max_length),
     max_lengthb(max_length*bus_width),
-    mm(20,max_lengthb),
+    mm(32,max_lengthb,32),
+    ts_slab_size(32),
     complete_queue("complete_queue")
 {
     launch_outstanding  = false;
     current_socket_id   = 0;
 
+    outstanding_head    = 0;
+    outstanding_tail    = 0;
+
+    dmi_enabled         = false;
+
+    recorder            = NULL;
+
+    lt_enabled          = false;
+    lt_done_time        = sc_core::SC_ZERO_TIME;
+
     socket.register_nb_transport_bw(this,&dlsc_tlm_initiator_nb<DATATYPE>::nb_transport_bw);
+    socket.register_invalidate_direct_mem_ptr(this,&dlsc_tlm_initiator_nb<DATATYPE>::invalidate_direct_mem_ptr);
 
     SC_METHOD(launch_method);
         sensitive << launch_event;
@@ -170,10 +287,46 @@ dlsc_tlm_initiator_nb<DATATYPE>::dlsc_tlm_initiator_nb(
         sensitive << complete_queue.get_event();
 }
 
+template <typename DATATYPE>
+dlsc_tlm_initiator_nb<DATATYPE>::~dlsc_tlm_initiator_nb() {
+    // drop our own references before their slots go away
+    launch_queue.clear();
+    while(outstanding_head) {
+        outstanding_remove(outstanding_head);
+    }
+
+    // handles held elsewhere may outlive us; leak their slabs, and detach every slot so
+    // the last release is harmless (the handles themselves must not otherwise be used)
+    const bool referenced = (ts_pool.size() != ts_slabs.size()*ts_slab_size);
+    for(unsigned int i=0;i<ts_slabs.size();++i) {
+        if(referenced) {
+            for(unsigned int j=0;j<ts_slab_size;++j) {
+                ts_slabs[i][j].parent = 0;
+            }
+        } else {
+            delete [] ts_slabs[i];
+        }
+    }
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::end_of_elaboration() {
     dlsc_info("targets bound: " << get_socket_size());
     assert(get_socket_size() > 0);
+    dmi_caches.resize(get_socket_size());
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::end_of_simulation() {
+    dlsc_info(mm);
+    if(recorder) {
+        recorder->flush();
+    }
+    if(dmi_enabled) {
+        for(unsigned int i=0;i<dmi_caches.size();++i) {
+            dlsc_info("socket #" << std::dec << i << ": " << dmi_caches[i]);
+        }
+    }
 }
 
 template <typename DATATYPE>
@@ -297,20 +450,105 @@ dlsc_tlm_initiator_nb<DATATYPE>::nb_write(
     return launch(trans,delay_initial);
 }
 
+// *** Large transfers ***
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transfer
+dlsc_tlm_initiator_nb<DATATYPE>::nb_read_transfer(
+    const uint64_t addr,
+    const unsigned int length,
+    sc_core::sc_time delay_initial
+) {
+    assert(length > 0 && (addr % bus_width) == 0);
+    transfer tf(new transfer_state(addr,length));
+    for(unsigned int i=0;i<length;) {
+        uint64_t a = addr + i*bus_width;
+        unsigned int n = burst_length(a,length-i);
+        tf->bursts.push_back(nb_read(a,n,delay_initial));
+        i += n;
+    }
+    return tf;
+}
+
+template <typename DATATYPE> template <class InputIterator>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transfer
+dlsc_tlm_initiator_nb<DATATYPE>::nb_write_transfer(
+    const uint64_t addr,
+    InputIterator first,
+    const InputIterator last,
+    sc_core::sc_time delay_initial
+) {
+    unsigned int length = last - first;
+    assert(length > 0 && (addr % bus_width) == 0);
+    transfer tf(new transfer_state(addr,length));
+    for(unsigned int i=0;i<length;) {
+        uint64_t a = addr + i*bus_width;
+        unsigned int n = burst_length(a,length-i);
+        tf->bursts.push_back(nb_write(a,first,first+n,delay_initial));
+        first += n;
+        i += n;
+    }
+    return tf;
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transfer
+dlsc_tlm_initiator_nb<DATATYPE>::nb_read_transfer(
+    const uint64_t addr,
+    DATATYPE *buf,
+    const unsigned int length,
+    sc_core::sc_time delay_initial
+) {
+    assert(buf && length > 0 && (addr % bus_width) == 0);
+    transfer tf(new transfer_state(addr,length));
+    for(unsigned int i=0;i<length;) {
+        uint64_t a = addr + i*bus_width;
+        unsigned int n = burst_length(a,length-i);
+        tf->bursts.push_back(launch_zero_copy(tlm::TLM_READ_COMMAND,a,reinterpret_cast<uint8_t*>(buf+i),n*bus_width,delay_initial));
+        i += n;
+    }
+    return tf;
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transfer
+dlsc_tlm_initiator_nb<DATATYPE>::nb_write_transfer(
+    const uint64_t addr,
+    DATATYPE *buf,
+    const unsigned int length,
+    sc_core::sc_time delay_initial
+) {
+    assert(buf && length > 0 && (addr % bus_width) == 0);
+    transfer tf(new transfer_state(addr,length));
+    for(unsigned int i=0;i<length;) {
+        uint64_t a = addr + i*bus_width;
+        unsigned int n = burst_length(a,length-i);
+        tf->bursts.push_back(launch_zero_copy(tlm::TLM_WRITE_COMMAND,a,reinterpret_cast<uint8_t*>(buf+i),n*bus_width,delay_initial));
+        i += n;
+    }
+    return tf;
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::wait() {
-    while(!outstanding.empty()) {
-        transaction ts = (*(outstanding.begin())).second;
+    while(outstanding_head) {
+        transaction ts(outstanding_head);
         ts->wait();
     }
+    if(lt_done_time > sc_core::sc_time_stamp()) {
+        sc_core::wait(lt_done_time - sc_core::sc_time_stamp());
+    }
 }
 
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::wait(sc_core::sc_time &delay) {
-    while(!outstanding.empty()) {
-        transaction ts = (*(outstanding.begin())).second;
+    while(outstanding_head) {
+        transaction ts(outstanding_head);
         ts->wait(delay);
     }
+    if(lt_done_time > sc_core::sc_time_stamp() + delay) {
+        delay = lt_done_time - sc_core::sc_time_stamp();
+        dlsc_tlm_quantum_wait(delay);
+    }
 }
 
 template <typename DATATYPE>
@@ -336,7 +574,7 @@ tlm::tlm_sync_enum dlsc_tlm_initiator_nb<DATATYPE>::nb_transport_bw(
     }
 
     if(phase == tlm::BEGIN_RESP) {
-        transaction ts = outstanding[&trans];
+        transaction ts(ts_lookup(trans));
         assert(ts && ts->get_socket_id() == id);
         complete_local(ts,delay);
 
@@ -349,6 +587,17 @@ tlm::tlm_sync_enum dlsc_tlm_initiator_nb<DATATYPE>::nb_transport_bw(
     return tlm::TLM_ACCEPTED;
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::invalidate_direct_mem_ptr(
+    int id,
+    sc_dt::uint64 start_range,
+    sc_dt::uint64 end_range)
+{
+    if(id < static_cast<int>(dmi_caches.size())) {
+        dmi_caches[id].invalidate(start_range,end_range);
+    }
+}
+
 
 // *** dlsc_tlm_initiator_nb private functions ***
 
@@ -390,17 +639,140 @@ void dlsc_tlm_initiator_nb<DATATYPE>::launch_update(sc_core::sc_time &delay) {
 
 template <typename DATATYPE>
 typename dlsc_tlm_initiator_nb<DATATYPE>::transaction dlsc_tlm_initiator_nb<DATATYPE>::launch(tlm::tlm_generic_payload *trans, sc_core::sc_time &delay) {
-    transaction ts(new transaction_state(trans,delay!=sc_core::SC_ZERO_TIME,current_socket_id));
+    transaction_state *tsp = ts_alloc();
+    tsp->init(trans,delay!=sc_core::SC_ZERO_TIME,current_socket_id,lt_enabled);
+    tsp->start_time = sc_core::sc_time_stamp() + delay;
+
+    // tie payload to slot
+    payload_extension *ext;
+    trans->get_extension(ext);
+    if(!ext) {
+        ext = new payload_extension;
+        trans->set_extension(ext);
+    }
+    ext->ts = tsp;
+
+    transaction ts(tsp);
+    outstanding_push(tsp);
+
+    if(dmi_transport(trans,delay)) {
+        // satisfied directly; never enters the launch queue
+        if(lt_enabled) {
+            complete_lt(ts,delay);
+        } else {
+            complete_local(ts,delay);
+        }
+        return ts;
+    }
+
+    if(lt_enabled && launch_queue.empty()) {
+        // blocking call can't overtake queued requests; otherwise go straight to target
+        socket[current_socket_id]->b_transport(*trans,delay);
+        if(dmi_enabled && trans->is_dmi_allowed()) {
+            dmi_caches[current_socket_id].set_hint(true);
+        }
+        complete_lt(ts,delay);
+        return ts;
+    }
+
     launch_queue.push_back(ts);
-    outstanding[trans] = ts;
     launch_update(delay);
     return ts;
 }
 
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transaction dlsc_tlm_initiator_nb<DATATYPE>::launch_zero_copy(
+    const tlm::tlm_command cmd,
+    const uint64_t addr,
+    uint8_t *ptr,
+    const unsigned int lengthb,
+    sc_core::sc_time delay)
+{
+    tlm::tlm_generic_payload *trans = mm.alloc();
+    uint8_t *owned = trans->get_data_ptr();
+    trans->set_command(cmd);
+    trans->set_address(addr);
+    trans->set_data_ptr(ptr);
+    trans->set_data_length(lengthb);
+    trans->set_byte_enable_length(0);
+    trans->set_streaming_width(lengthb);
+
+    transaction ts = launch(trans,delay);
+    // slot hands the payload's own buffer back when recycled
+    ts->owned_data = owned;
+    return ts;
+}
+
+template <typename DATATYPE>
+unsigned int dlsc_tlm_initiator_nb<DATATYPE>::burst_length(const uint64_t addr, const unsigned int remaining) const {
+    const unsigned int to_boundary = (4096 - (addr % 4096)) / bus_width;
+    return std::min(std::min(remaining,max_length),to_boundary);
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_initiator_nb<DATATYPE>::dmi_transport(tlm::tlm_generic_payload *trans, sc_core::sc_time &delay) {
+    // can't overtake any earlier transaction that's still outstanding (queued, or accepted
+    // but not yet complete), or a read could miss an in-flight write; this one is the tail
+    if(!dmi_enabled || outstanding_head != outstanding_tail || !(trans->is_read() || trans->is_write())) {
+        return false;
+    }
+
+    dlsc_tlm_dmi_cache &cache   = dmi_caches[current_socket_id];
+    const bool write            = trans->is_write();
+    const uint64_t addr         = trans->get_address();
+    const unsigned int lengthb  = trans->get_data_length();
+
+    sc_core::sc_time latency;
+    uint8_t *ptr = cache.lookup(addr,lengthb,write,latency);
+
+    if(!ptr && cache.get_hint()) {
+        tlm::tlm_dmi dmi_data;
+        if(socket[current_socket_id]->get_direct_mem_ptr(*trans,dmi_data) && dmi_data.get_dmi_ptr()) {
+            cache.insert(dmi_data);
+            ptr = cache.lookup(addr,lengthb,write,latency);
+        } else {
+            // don't ask again until target indicates otherwise
+            cache.set_hint(false);
+        }
+    }
+
+    if(!ptr) {
+        return false;
+    }
+
+    uint8_t *src_ptr    = write ? trans->get_data_ptr() : ptr;
+    uint8_t *dest_ptr   = write ? ptr : trans->get_data_ptr();
+
+    unsigned int be_length = trans->get_byte_enable_length();
+
+    if(!be_length) {
+        std::copy(src_ptr,src_ptr+lengthb,dest_ptr);
+    } else {
+        uint8_t *be_ptr = trans->get_byte_enable_ptr();
+        unsigned int be = 0;
+        for(unsigned int i=0;i<lengthb;++i) {
+            if(be_ptr[be] == TLM_BYTE_ENABLED) dest_ptr[i] = src_ptr[i];
+            if(++be == be_length) be = 0;
+        }
+    }
+
+    trans->set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += latency * lengthb;
+    return true;
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::complete_local(transaction ts, sc_core::sc_time &delay) {
+    if(dmi_enabled && ts->get_payload()->is_dmi_allowed()) {
+        dmi_caches[ts->get_socket_id()].set_hint(true);
+    }
+
     ts->notify_local(sc_core::sc_time_stamp() + delay);
 
+    if(recorder) {
+        recorder->record(ts->start_time,ts->done_time,*ts->get_payload(),ts->get_socket_id(),-1,ts->get_address());
+    }
+
     if(delay == sc_core::SC_ZERO_TIME) {
         complete_final(ts); // will notify
     } else {
@@ -408,22 +780,113 @@ void dlsc_tlm_initiator_nb<DATATYPE>::complete_local(transaction ts, sc_core::sc
     }
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::complete_lt(transaction ts, sc_core::sc_time &delay) {
+    // no event/PEQ round trip; waiters account for done_time themselves
+    sc_core::sc_time done_time = sc_core::sc_time_stamp() + delay;
+    if(done_time > lt_done_time) {
+        lt_done_time = done_time;
+    }
+    ts->notify_local(done_time);
+    if(recorder) {
+        recorder->record(ts->start_time,done_time,*ts->get_payload(),ts->get_socket_id(),-1,ts->get_address());
+    }
+    complete_final(ts);
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::complete_final(transaction ts) {
-    outstanding.erase(ts->get_payload());
     ts->notify();
+    outstanding_remove(ts.get());
 }
 
 template <typename DATATYPE>
 void dlsc_tlm_initiator_nb<DATATYPE>::complete_method() {
     tlm::tlm_generic_payload *trans;
     while( (trans = complete_queue.get_next_transaction()) ) {
-        transaction ts = outstanding[trans];
+        transaction ts(ts_lookup(*trans));
         assert(ts);
         complete_final(ts);
     }
 }
 
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transaction_state *dlsc_tlm_initiator_nb<DATATYPE>::ts_alloc() {
+    if(ts_pool.empty()) {
+        transaction_state *slab = new transaction_state[ts_slab_size];
+        ts_slabs.push_back(slab);
+        ts_pool.reserve(ts_pool.size() + ts_slab_size);
+        for(int i=ts_slab_size-1;i>=0;--i) {
+            slab[i].parent = this;
+            ts_pool.push_back(&slab[i]);
+        }
+    }
+
+    transaction_state *ts = ts_pool.back();
+    ts_pool.pop_back();
+    return ts;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::ts_free(transaction_state *ts) {
+    assert(ts && ts->payload && ts->refcnt == 0);
+
+    payload_extension *ext;
+    ts->payload->get_extension(ext);
+    if(ext) ext->ts = 0;
+
+    if(ts->owned_data) {
+        // was carrying a caller's buffer (zero-copy)
+        ts->payload->set_data_ptr(ts->owned_data);
+        ts->owned_data = 0;
+    }
+
+    ts->payload->release();
+    ts->payload = 0;
+
+    ts_pool.push_back(ts);
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_initiator_nb<DATATYPE>::transaction_state *dlsc_tlm_initiator_nb<DATATYPE>::ts_lookup(tlm::tlm_generic_payload &trans) {
+    payload_extension *ext;
+    trans.get_extension(ext);
+    assert(ext && ext->ts && ext->ts->payload == &trans);
+    return ext->ts;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::outstanding_push(transaction_state *ts) {
+    intrusive_ptr_add_ref(ts);
+    ts->prev    = outstanding_tail;
+    ts->next    = 0;
+    if(outstanding_tail) {
+        outstanding_tail->next = ts;
+    } else {
+        outstanding_head = ts;
+    }
+    outstanding_tail = ts;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::outstanding_remove(transaction_state *ts) {
+    if(ts->prev) {
+        ts->prev->next = ts->next;
+    } else {
+        assert(outstanding_head == ts);
+        outstanding_head = ts->next;
+    }
+    if(ts->next) {
+        ts->next->prev = ts->prev;
+    } else {
+        assert(outstanding_tail == ts);
+        outstanding_tail = ts->prev;
+    }
+    ts->prev    = 0;
+    ts->next    = 0;
+    intrusive_ptr_release(ts);
+}
+
 
 
 
@@ -465,6 +928,10 @@ public:
     inline uint64_t get_address() { return addr; }
     inline unsigned int size() { return payload->get_data_length()/sizeof(DATATYPE); }
     inline int get_socket_id() { return socket_id; }
+
+    // launch/completion times (completion time is only valid once done)
+    inline sc_core::sc_time get_start_time() { return start_time; }
+    inline sc_core::sc_time get_done_time() { return done_time; }
     
     // get payload strobes
     inline bool has_strobes() { return (payload->get_byte_enable_length() != 0); }
@@ -473,34 +940,56 @@ public:
     inline void get_strobes(std::vector<uint32_t> &strb) { strb.resize(size()); get_strobes(strb.begin()); }
     inline void get_strobes(std::deque<uint32_t>  &strb) { strb.resize(size()); get_strobes(strb.begin()); }
 
-    ~transaction_state();
+    // reference counting for boost::intrusive_ptr
+    friend inline void intrusive_ptr_add_ref(transaction_state *ts) { ++ts->refcnt; }
+    friend inline void intrusive_ptr_release(transaction_state *ts) { assert(ts->refcnt > 0); if(--ts->refcnt == 0) ts->recycle(); }
 
 private:
     // no copying/assigning
     transaction_state(const transaction_state&);
     transaction_state& operator= (const transaction_state&);
 
-    transaction_state(tlm::tlm_generic_payload *payload, bool tann, int socket_id);
+    // slots are only created (in bulk) by the parent initiator
+    transaction_state();
+
+    // (re)initializes a free slot for a new transaction
+    void init(tlm::tlm_generic_payload *payload, bool tann, int socket_id, bool lt);
+
+    // returns slot to parent once unreferenced (unless parent is already gone)
+    inline void recycle() { if(parent) parent->ts_free(this); }
 
     void notify_local(sc_core::sc_time dt);
     void notify();
 
     inline tlm::tlm_generic_payload* get_payload();
 
+    dlsc_tlm_initiator_nb<DATATYPE>     *parent;
+
     tlm::tlm_generic_payload            *payload;
 
-    const uint64_t                      addr;               // address saved from initial transaction (prior to possible translation by interconnect)
+    unsigned int                        refcnt;
+
+    transaction_state                   *prev;              // outstanding list links
+    transaction_state                   *next;
+
+    uint64_t                            addr;               // address saved from initial transaction (prior to possible translation by interconnect)
+
+    uint8_t                             *owned_data;        // payload's own data buffer, while payload points at a caller's (zero-copy)
 
     sc_core::sc_event                   done_event;
 
+    sc_core::sc_time                    start_time;         // time that transaction was launched
+
     sc_core::sc_time                    done_time;          // time that transaction actually completes
 
     bool                                done_flag;          // transaction actually complete (done_time reached)
     bool                                done_flag_local;    // transaction complete (response received)
 
-    const bool                          was_annotated;      // indicates transaction was created with a timing-annotated call
+    bool                                was_annotated;      // indicates transaction was created with a timing-annotated call
 
-    const int                           socket_id;
+    bool                                lt;                 // completed by loosely-timed path (done_flag set before done_time)
+
+    int                                 socket_id;
 
     friend class dlsc_tlm_initiator_nb<DATATYPE>;
 };
@@ -514,6 +1003,10 @@ void dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::wait() {
         // done_event may fire twice (once for done_flag_local; once for done_flag)
         sc_core::wait(done_event);
     }
+
+    if(lt && done_time > sc_core::sc_time_stamp()) {
+        sc_core::wait(done_time - sc_core::sc_time_stamp());
+    }
 }
 
 template <typename DATATYPE>
@@ -549,7 +1042,7 @@ void dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::wait(sc_core::sc_time &
 
 template <typename DATATYPE>
 inline bool dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::nb_done() {
-    return done_flag;
+    return done_flag && !(lt && sc_core::sc_time_stamp() < done_time);
 }
 
 template <typename DATATYPE>
@@ -676,25 +1169,40 @@ tlm::tlm_response_status dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::b_s
 }
 
 
+// *** private functions ***
+
 template <typename DATATYPE>
-dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::~transaction_state() {
-    payload->release();
+dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::transaction_state() :
+    parent(0),
+    payload(0),
+    refcnt(0),
+    prev(0),
+    next(0),
+    addr(0),
+    owned_data(0),
+    was_annotated(false),
+    lt(false),
+    socket_id(0)
+{
+    done_time       = sc_core::SC_ZERO_TIME;
+    done_flag       = false;
+    done_flag_local = false;
 }
 
-// *** private functions ***
-
 template <typename DATATYPE>
-dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::transaction_state(
+void dlsc_tlm_initiator_nb<DATATYPE>::transaction_state::init(
     tlm::tlm_generic_payload *payload,
     bool tann,
-    int socket_id
-) :
-    payload(payload),
-    addr(payload->get_address()),
-    was_annotated(tann),
-    socket_id(socket_id)
-{
+    int socket_id,
+    bool lt
+) {
+    assert(parent && !this->payload && refcnt == 0);
     payload->acquire();
+    this->payload   = payload;
+    this->addr      = payload->get_address();
+    was_annotated   = tann;
+    this->lt        = lt;
+    this->socket_id = socket_id;
     done_time       = sc_core::SC_ZERO_TIME;
     done_flag       = false;
     done_flag_local = false;
@@ -719,5 +1227,126 @@ inline tlm::tlm_generic_payload* dlsc_tlm_initiator_nb<DATATYPE>::transaction_st
     return payload;
 }
 
+
+
+
+// aggregate of the bursts making up a large transfer
+template <typename DATATYPE>
+class dlsc_tlm_initiator_nb<DATATYPE>::transfer_state {
+public:
+
+    void wait();
+    void wait(sc_core::sc_time &delay);
+
+    bool nb_done();
+    bool nb_done(sc_core::sc_time &delay);
+
+    // *** Blocking Reads ***
+    // for zero-copy reads, data is already in the caller's buffer once complete
+
+    template<class InputIterator>
+    bool b_read(InputIterator first, sc_core::sc_time &delay);
+    inline bool b_read(std::vector<DATATYPE> &data, sc_core::sc_time &delay) { data.resize(length); return b_read(data.begin(),delay); }
+
+    template<class InputIterator>
+    bool b_read(InputIterator first);
+    inline bool b_read(std::vector<DATATYPE> &data) { data.resize(length); return b_read(data.begin()); }
+
+    // first non-okay response of any burst (or TLM_OK_RESPONSE)
+    tlm::tlm_response_status b_status(sc_core::sc_time &delay);
+    tlm::tlm_response_status b_status();
+
+    // get transfer properties
+    inline bool is_read() { return bursts.front()->is_read(); }
+    inline bool is_write() { return bursts.front()->is_write(); }
+    inline uint64_t get_address() { return addr; }
+    inline unsigned int size() { return length; }
+    inline unsigned int get_burst_count() { return bursts.size(); }
+    inline transaction get_burst(const unsigned int i) { return bursts[i]; }
+
+private:
+    // no copying/assigning
+    transfer_state(const transfer_state&);
+    transfer_state& operator= (const transfer_state&);
+
+    transfer_state(const uint64_t addr, const unsigned int length) : addr(addr), length(length) {}
+
+    const uint64_t              addr;
+    const unsigned int          length;             // words
+    std::vector<transaction>    bursts;             // in address order
+
+    friend class dlsc_tlm_initiator_nb<DATATYPE>;
+};
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::wait() {
+    for(unsigned int i=0;i<bursts.size();++i) {
+        bursts[i]->wait();
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::wait(sc_core::sc_time &delay) {
+    for(unsigned int i=0;i<bursts.size();++i) {
+        bursts[i]->wait(delay);
+    }
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::nb_done() {
+    for(unsigned int i=0;i<bursts.size();++i) {
+        if(!bursts[i]->nb_done()) return false;
+    }
+    return true;
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::nb_done(sc_core::sc_time &delay) {
+    for(unsigned int i=0;i<bursts.size();++i) {
+        if(!bursts[i]->nb_done(delay)) return false;
+    }
+    return true;
+}
+
+template <typename DATATYPE> template <class InputIterator>
+bool dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::b_read(InputIterator first, sc_core::sc_time &delay) {
+    bool okay = true;
+    for(unsigned int i=0;i<bursts.size();++i) {
+        if(!bursts[i]->b_read(first,delay)) okay = false;
+        first += bursts[i]->size();
+    }
+    return okay;
+}
+
+template <typename DATATYPE> template <class InputIterator>
+bool dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::b_read(InputIterator first) {
+    bool okay = true;
+    for(unsigned int i=0;i<bursts.size();++i) {
+        if(!bursts[i]->b_read(first)) okay = false;
+        first += bursts[i]->size();
+    }
+    return okay;
+}
+
+template <typename DATATYPE>
+tlm::tlm_response_status dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::b_status(sc_core::sc_time &delay) {
+    tlm::tlm_response_status status = tlm::TLM_OK_RESPONSE;
+    for(unsigned int i=0;i<bursts.size();++i) {
+        tlm::tlm_response_status s = bursts[i]->b_status(delay);
+        if(status == tlm::TLM_OK_RESPONSE) status = s;
+    }
+    return status;
+}
+
+template <typename DATATYPE>
+tlm::tlm_response_status dlsc_tlm_initiator_nb<DATATYPE>::transfer_state::b_status() {
+    tlm::tlm_response_status status = tlm::TLM_OK_RESPONSE;
+    for(unsigned int i=0;i<bursts.size();++i) {
+        tlm::tlm_response_status s = bursts[i]->b_status();
+        if(status == tlm::TLM_OK_RESPONSE) status = s;
+    }
+    return status;
+}
+
 #endif
 
@@ -7,11 +7,18 @@
 #include <tlm_utils/multi_passthrough_target_socket.h>
 
 #include <deque>
-#include <map>
+#include <vector>
+#include <string>
+#include <cstring>
 #include <algorithm>
-#include <boost/shared_array.hpp>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t>
 class dlsc_tlm_memory : public sc_core::sc_module {
@@ -27,9 +34,35 @@ public:
         const sc_core::sc_time          byte_latency    = sc_core::SC_ZERO_TIME,    // time it takes to transfer a single byte
         const sc_core::sc_time          access_latency  = sc_core::SC_ZERO_TIME);   // time it takes to setup a burst
 
+    // DRAM timing model (optional); replaces access_latency with per-bank row buffer
+    // timing, while byte_latency still sets the data bus rate
+    struct dram_config {
+        dram_config() :
+            banks           (8),
+            row_size        (2048),
+            t_hit           (15.0,sc_core::SC_NS),
+            t_miss          (30.0,sc_core::SC_NS),
+            t_conflict      (45.0,sc_core::SC_NS),
+            t_refi          (7800.0,sc_core::SC_NS),
+            t_rfc           (110.0,sc_core::SC_NS),
+            t_turnaround    (7.5,sc_core::SC_NS)
+        {}
+
+        unsigned int        banks;          // addresses map as row:bank:column
+        unsigned int        row_size;       // bytes per row (per bank)
+        sc_core::sc_time    t_hit;          // access to open row (CAS)
+        sc_core::sc_time    t_miss;         // access to idle bank (ACT + CAS)
+        sc_core::sc_time    t_conflict;     // access to bank with another row open (PRE + ACT + CAS)
+        sc_core::sc_time    t_refi;         // refresh interval (zero disables refresh)
+        sc_core::sc_time    t_rfc;          // refresh duration; all banks are closed afterwards
+        sc_core::sc_time    t_turnaround;   // data bus idle time when switching between reads and writes
+    };
+
+    void set_dram(const dram_config &cfg);
+
     void set_error_rate(const float err) { set_error_rate_read(err); set_error_rate_write(err); }
-    void set_error_rate_read(const float err) { assert(err >= 0.0 && err <= 100.0); this->error_rate_read = (int)(err*10.0); }
-    void set_error_rate_write(const float err) { assert(err >= 0.0 && err <= 100.0); this->error_rate_write = (int)(err*10.0); }
+    void set_error_rate_read(const float err) { assert(err >= 0.0 && err <= 100.0); this->error_rate_read = (int)(err*10.0); dmi_update(); }
+    void set_error_rate_write(const float err) { assert(err >= 0.0 && err <= 100.0); this->error_rate_write = (int)(err*10.0); dmi_update(); }
 
 
     // Backdoor memory access
@@ -62,7 +95,24 @@ public:
         nb_write(addr,data.begin(),data.end());
     }
 
+
+    // Memory images
+
+    // raw image placed at addr; untouched blocks covered entirely by the image
+    // are mapped copy-on-write from the file rather than copied
+    bool load(const std::string &filename, const uint64_t addr = 0);
+
+    // ELF image; PT_LOAD segments are placed at their physical addresses
+    bool load_elf(const std::string &filename);
+
+    // raw image of [addr,addr+length); length of 0 dumps the entire memory
+    bool dump(const std::string &filename, const uint64_t addr = 0, const uint64_t length = 0);
+
+    // dumps (as above) at end of simulation
+    void set_dump_on_exit(const std::string &filename, const uint64_t addr = 0, const uint64_t length = 0);
+
     void end_of_elaboration();
+    void end_of_simulation();
 
     ~dlsc_tlm_memory();
 
@@ -73,11 +123,13 @@ private:
 
     int                         error_rate_read;    // percentage of transactions to have fail (0-1000)
     int                         error_rate_write;   // percentage of transactions to have fail (0-1000)
+    dlsc_random_stream          rng;                // for error injection
 
     const unsigned int          bus_width;
 
     const uint64_t              mem_size;
     const uint64_t              block_size;
+    const uint64_t              page_size;          // granularity at which blocks are initialized
 
     const uint64_t              mem_mask;
     const uint64_t              block_mask;
@@ -91,10 +143,68 @@ private:
     bool                        delay_enabled;
 
     sc_core::sc_time            next_time;
+
+    // DRAM
+    struct dram_bank {
+        bool                    open;
+        uint64_t                row;
+        sc_core::sc_time        ready_time;     // bank can accept next command
+    };
+
+    bool                        dram_enabled;
+    dram_config                 dram_cfg;
+    std::vector<dram_bank>      dram_banks;
+    sc_core::sc_time            dram_next_refresh;
+    bool                        dram_last_write;
+
+    uint64_t                    dram_hits;
+    uint64_t                    dram_misses;
+    uint64_t                    dram_conflicts;
+    uint64_t                    dram_refreshes;
+    uint64_t                    dram_turnarounds;
+    uint64_t                    dram_bytes;
+
+    void dram_refresh(sc_core::sc_time &cmd_time);
+    sc_core::sc_time dram_access(const uint64_t addr, const unsigned int length, const bool write, const sc_core::sc_time &req_time);
     
-    std::map<uint64_t,boost::shared_array<uint8_t> > blocks;
-    
-    uint8_t *get_block_ptr(const uint64_t addr);
+    // backing store: two-level table of lazily mmap'd blocks; only the pages of a
+    // block that have actually been touched get the initial address pattern
+    struct mem_block;
+    static const unsigned int   table_bits = 9;     // blocks per second-level table: 2**table_bits
+    unsigned int                block_bits;
+    unsigned int                pages_per_block;
+    std::vector<mem_block**>    tables;
+
+    uint64_t                    last_block_addr;    // most recently accessed block
+    mem_block                   *last_block;
+
+    mem_block *&get_block_slot(const uint64_t addr);
+    mem_block *get_block(const uint64_t addr);
+    void init_pages(mem_block *blk, const uint64_t block_addr, const uint64_t offset, const uint64_t length);
+    void init_pattern(uint8_t *ptr, uint64_t addr, const uint64_t length);
+
+    // images
+    std::string                 dump_filename;
+    uint64_t                    dump_addr;
+    uint64_t                    dump_length;
+
+    void load_region(const int fd, const uint8_t *src, uint64_t file_offset, uint64_t addr, uint64_t length);
+    void fill_region(uint64_t addr, uint64_t length);
+
+    // returns pointer to addr; [addr,addr+length) must be within one block
+    inline uint8_t *get_block_ptr(const uint64_t addr, const uint64_t length) {
+        mem_block *blk = (addr & blocks_mask) == last_block_addr ? last_block : get_block(addr);
+        if(blk->pages_init < pages_per_block) {
+            init_pages(blk,addr & blocks_mask,addr & block_mask,length);
+        }
+        return blk->data + (addr & block_mask);
+    }
+
+    // DMI would bypass error injection and all timing (latencies, bandwidth, DRAM), so it is only
+    // granted to an untimed memory that isn't injecting errors
+    inline bool dmi_okay() const { return error_rate_read == 0 && error_rate_write == 0 && !dram_enabled && !delay_enabled; }
+    bool dmi_granted;
+    void dmi_update();
 
     // multi_passthrough_target_socket callbacks
     tlm::tlm_sync_enum nb_transport_fw(int id,tlm::tlm_generic_payload &trans, tlm::tlm_phase &phase, sc_core::sc_time &delay);
@@ -105,6 +215,15 @@ private:
     friend class tlm_utils::multi_passthrough_target_socket<dlsc_tlm_memory<DATATYPE>,sizeof(DATATYPE)*8,tlm::tlm_base_protocol_types>;
 };
 
+template <typename DATATYPE>
+struct dlsc_tlm_memory<DATATYPE>::mem_block {
+    mem_block() : data(NULL), pages_init(0) {}
+
+    uint8_t             *data;
+    unsigned int        pages_init;         // number of pages with address pattern applied
+    std::vector<bool>   page_init;
+};
+
 template <typename DATATYPE>
 dlsc_tlm_memory<DATATYPE>::dlsc_tlm_memory(
     const sc_core::sc_module_name &nm,
@@ -115,9 +234,11 @@ dlsc_tlm_memory<DATATYPE>::dlsc_tlm_memory(
 ) :
     sc_module       (nm),
     socket          ("socket"),
+    rng             (this->name()),
     bus_width       (sizeof(DATATYPE)),
     mem_size        (mem_size),                 // ex: 0x01000000 (16*1024*1024)
     block_size      (2*1024*1024),              // ex: 0x00100000 ( 1*1024*1024)
+    page_size       (4096),
     mem_mask        (mem_size - 1),             // ex: 0x00FFFFFF
     block_mask      (block_size - 1),           // ex: 0x000FFFFF
     blocks_mask     (mem_mask & ~block_mask),   // ex: 0x00F00000
@@ -138,8 +259,26 @@ dlsc_tlm_memory<DATATYPE>::dlsc_tlm_memory(
 
     delay_enabled   = byte_latency != sc_core::SC_ZERO_TIME || access_latency != sc_core::SC_ZERO_TIME;
 
+    dram_enabled    = false;
+
     error_rate_read     = 0;
     error_rate_write    = 0;
+
+    dmi_granted         = false;
+
+    block_bits          = 0;
+    while((1ull<<block_bits) < block_size) ++block_bits;
+    pages_per_block     = block_size / page_size;
+
+    // first-level table covers the whole address space; second-level tables are allocated on demand
+    uint64_t block_cnt  = mem_size >> block_bits;
+    tables.resize((block_cnt + (1<<table_bits) - 1) >> table_bits, NULL);
+
+    last_block_addr     = ~((uint64_t)0);   // can't match a block address
+    last_block          = NULL;
+
+    dump_addr           = 0;
+    dump_length         = 0;
 }
 
 template <typename DATATYPE> template <class InputIterator>
@@ -159,7 +298,7 @@ void dlsc_tlm_memory<DATATYPE>::nb_read(
         if(lim > (last-first))
             lim     = (last-first);
 
-        ptr     = reinterpret_cast<DATATYPE*>(get_block_ptr(addr));
+        ptr     = reinterpret_cast<DATATYPE*>(get_block_ptr(addr,lim*sizeof(DATATYPE)));
 
         std::copy(ptr,ptr+lim,first);
 
@@ -185,7 +324,7 @@ void dlsc_tlm_memory<DATATYPE>::nb_write(
         if(lim > (last-first))
             lim     = (last-first);
 
-        ptr     = reinterpret_cast<DATATYPE*>(get_block_ptr(addr));
+        ptr     = reinterpret_cast<DATATYPE*>(get_block_ptr(addr,lim*sizeof(DATATYPE)));
 
         std::copy(first,first+lim,ptr);
 
@@ -194,18 +333,244 @@ void dlsc_tlm_memory<DATATYPE>::nb_write(
     }
 }
 
+template <typename DATATYPE>
+bool dlsc_tlm_memory<DATATYPE>::load(const std::string &filename, const uint64_t addr) {
+    int fd = open(filename.c_str(),O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd,&st) != 0) {
+        dlsc_error("failed to open image '" << filename << "'");
+        if(fd >= 0) close(fd);
+        return false;
+    }
+
+    const uint64_t length = st.st_size;
+    if(length > mem_size) {
+        dlsc_error("image '" << filename << "' (" << std::dec << length << " bytes) is larger than memory");
+        close(fd);
+        return false;
+    }
+
+    if(length > 0) {
+        void *src = mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,0);
+        if(src == MAP_FAILED) {
+            dlsc_error("failed to map image '" << filename << "'");
+            close(fd);
+            return false;
+        }
+        load_region(fd,reinterpret_cast<const uint8_t*>(src),0,addr,length);
+        munmap(src,length);
+    }
+
+    close(fd);
+
+    dlsc_info("loaded " << std::dec << length << " bytes from '" << filename << "' at 0x" << std::hex << addr);
+    return true;
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_memory<DATATYPE>::load_elf(const std::string &filename) {
+    int fd = open(filename.c_str(),O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd,&st) != 0) {
+        dlsc_error("failed to open image '" << filename << "'");
+        if(fd >= 0) close(fd);
+        return false;
+    }
+
+    const uint64_t length = st.st_size;
+    void *map = (length >= EI_NIDENT) ? mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,0) : MAP_FAILED;
+    if(map == MAP_FAILED) {
+        dlsc_error("failed to map image '" << filename << "'");
+        close(fd);
+        return false;
+    }
+
+    const uint8_t *src = reinterpret_cast<const uint8_t*>(map);
+    const bool is64 = (src[EI_CLASS] == ELFCLASS64);
+
+    bool okay = (memcmp(src,ELFMAG,SELFMAG) == 0) && src[EI_DATA] == ELFDATA2LSB &&
+        (src[EI_CLASS] == ELFCLASS32 || src[EI_CLASS] == ELFCLASS64) &&
+        length >= (is64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr));
+
+    uint64_t phoff = 0;
+    unsigned int phnum = 0, phentsize = 0;
+    if(okay) {
+        if(is64) {
+            const Elf64_Ehdr *eh = reinterpret_cast<const Elf64_Ehdr*>(src);
+            phoff = eh->e_phoff; phnum = eh->e_phnum; phentsize = eh->e_phentsize;
+        } else {
+            const Elf32_Ehdr *eh = reinterpret_cast<const Elf32_Ehdr*>(src);
+            phoff = eh->e_phoff; phnum = eh->e_phnum; phentsize = eh->e_phentsize;
+        }
+        okay = phentsize >= (is64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr)) && phoff + phnum*phentsize <= length;
+    }
+
+    if(!okay) {
+        dlsc_error("'" << filename << "' is not a supported (little-endian) ELF image");
+        munmap(map,length);
+        close(fd);
+        return false;
+    }
+
+    for(unsigned int i=0;i<phnum;++i) {
+        uint64_t type, offset, paddr, filesz, memsz;
+        if(is64) {
+            const Elf64_Phdr *ph = reinterpret_cast<const Elf64_Phdr*>(src+phoff+i*phentsize);
+            type = ph->p_type; offset = ph->p_offset; paddr = ph->p_paddr; filesz = ph->p_filesz; memsz = ph->p_memsz;
+        } else {
+            const Elf32_Phdr *ph = reinterpret_cast<const Elf32_Phdr*>(src+phoff+i*phentsize);
+            type = ph->p_type; offset = ph->p_offset; paddr = ph->p_paddr; filesz = ph->p_filesz; memsz = ph->p_memsz;
+        }
+
+        if(type != PT_LOAD || memsz == 0) continue;
+
+        if(offset + filesz > length || memsz < filesz || memsz > mem_size) {
+            dlsc_error("'" << filename << "' segment #" << std::dec << i << " is malformed");
+            okay = false;
+            break;
+        }
+
+        // addresses wrap within the memory, so an out-of-range segment would silently
+        // land on (and overwrite) some other part of it
+        if(paddr < base_addr || (paddr - base_addr) > (mem_size - memsz)) {
+            dlsc_error("'" << filename << "' segment #" << std::dec << i << " (0x" << std::hex << paddr << ", " << std::dec << memsz << " bytes) is outside of memory");
+            okay = false;
+            break;
+        }
+
+        dlsc_verb("loading segment #" << std::dec << i << " at 0x" << std::hex << paddr << " (" << std::dec << memsz << " bytes)");
+
+        load_region(fd,src,offset,paddr,filesz);
+        fill_region(paddr+filesz,memsz-filesz);    // .bss
+    }
+
+    munmap(map,length);
+    close(fd);
+
+    if(okay) dlsc_info("loaded '" << filename << "'");
+    return okay;
+}
+
+template <typename DATATYPE>
+bool dlsc_tlm_memory<DATATYPE>::dump(const std::string &filename, uint64_t addr, const uint64_t length) {
+    assert(addr % bus_width == 0 && length % bus_width == 0 && length <= mem_size);
+
+    int fd = open(filename.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    if(fd < 0) {
+        dlsc_error("failed to create image '" << filename << "'");
+        return false;
+    }
+
+    uint64_t remaining = length ? length : mem_size;
+    std::vector<uint8_t> scratch;
+    bool okay = true;
+
+    while(okay && remaining) {
+        uint64_t lim = std::min(block_size - (addr & block_mask),remaining);
+        const uint8_t *ptr;
+
+        if(get_block_slot(addr)) {
+            ptr = get_block_ptr(addr,lim);
+        } else {
+            // never touched; generate what a read would return without allocating the block
+            scratch.resize(block_size);
+            init_pattern(&scratch[0],addr,lim);
+            ptr = &scratch[0];
+        }
+
+        while(lim) {
+            ssize_t r = write(fd,ptr,lim);
+            if(r <= 0) { okay = false; break; }
+            ptr         += r;
+            addr        += r;
+            remaining   -= r;
+            lim         -= r;
+        }
+    }
+
+    if(close(fd) != 0) okay = false;
+
+    if(okay) {
+        dlsc_info("dumped " << std::dec << (length ? length : mem_size) << " bytes to '" << filename << "'");
+    } else {
+        dlsc_error("failed writing image '" << filename << "'");
+    }
+    return okay;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::set_dump_on_exit(const std::string &filename, const uint64_t addr, const uint64_t length) {
+    dump_filename   = filename;
+    dump_addr       = addr;
+    dump_length     = length;
+}
+
 template <typename DATATYPE>
 void dlsc_tlm_memory<DATATYPE>::end_of_elaboration() {
     dlsc_info("initiators bound: " << socket.size());
     assert(socket.size() > 0);
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::set_dram(const dram_config &cfg) {
+    assert(cfg.banks > 0 && cfg.row_size > 0);
+    assert(cfg.t_refi == sc_core::SC_ZERO_TIME || cfg.t_refi > cfg.t_rfc);
+
+    dram_enabled        = true;
+    dram_cfg            = cfg;
+
+    dram_bank b;
+    b.open              = false;
+    b.row               = 0;
+    b.ready_time        = sc_core::SC_ZERO_TIME;
+    dram_banks.assign(cfg.banks,b);
+
+    dram_next_refresh   = cfg.t_refi;
+    dram_last_write     = false;
+
+    dram_hits           = 0;
+    dram_misses         = 0;
+    dram_conflicts      = 0;
+    dram_refreshes      = 0;
+    dram_turnarounds    = 0;
+    dram_bytes          = 0;
+
+    dmi_update();
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::end_of_simulation() {
+    if(dram_enabled) {
+        dlsc_info("DRAM row hits: " << std::dec << dram_hits << ", misses: " << dram_misses << ", conflicts: " << dram_conflicts
+            << ", refreshes: " << dram_refreshes << ", turnarounds: " << dram_turnarounds);
+        if(next_time > sc_core::SC_ZERO_TIME) {
+            double mbps = (dram_bytes / next_time.to_seconds()) / 1000000.0;
+            dlsc_info("DRAM transferred " << dram_bytes << " bytes; sustained bandwidth: " << mbps << " MB/s");
+        }
+    }
+    if(!dump_filename.empty()) {
+        dump(dump_filename,dump_addr,dump_length);
+    }
+}
+
 template <typename DATATYPE>
 dlsc_tlm_memory<DATATYPE>::~dlsc_tlm_memory() {
     // invalidate all DMI pointers on destruction
     for(unsigned int i=0;i<socket.size();++i) {
         socket[i]->invalidate_direct_mem_ptr(0x0,(sc_dt::uint64)-1);
     }
+
+    // release backing store
+    for(unsigned int i=0;i<tables.size();++i) {
+        if(!tables[i]) continue;
+        for(unsigned int j=0;j<(1u<<table_bits);++j) {
+            mem_block *blk = tables[i][j];
+            if(!blk) continue;
+            munmap(blk->data,block_size);
+            delete blk;
+        }
+        delete [] tables[i];
+    }
 }
 
 template <typename DATATYPE>
@@ -246,7 +611,10 @@ void dlsc_tlm_memory<DATATYPE>::b_transport(int id, tlm::tlm_generic_payload &tr
     }
 
     // compute completion time
-    if(delay_enabled) {
+    if(dram_enabled) {
+        // completion time (initiator's local time)
+        delay = dram_access(addr,length,trans.is_write(),sc_core::sc_time_stamp() + delay) - sc_core::sc_time_stamp();
+    } else if(delay_enabled) {
         // can't use the past's bandwidth!
         if(next_time < sc_core::sc_time_stamp()) {
             next_time = sc_core::sc_time_stamp();
@@ -276,8 +644,8 @@ void dlsc_tlm_memory<DATATYPE>::b_transport(int id, tlm::tlm_generic_payload &tr
         }
     }
     
-    if( (trans.is_read()  && error_rate_read  > 0 && (rand()%1000) < error_rate_read ) ||
-        (trans.is_write() && error_rate_write > 0 && (rand()%1000) < error_rate_write) )
+    if( (trans.is_read()  && error_rate_read  > 0 && (int)rng.below(1000) < error_rate_read ) ||
+        (trans.is_write() && error_rate_write > 0 && (int)rng.below(1000) < error_rate_write) )
     {
         // generate error
         trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
@@ -290,9 +658,9 @@ void dlsc_tlm_memory<DATATYPE>::b_transport(int id, tlm::tlm_generic_payload &tr
 
     if(trans.is_write()) {
         src_ptr     = trans.get_data_ptr();
-        dest_ptr    = get_block_ptr(addr);
+        dest_ptr    = get_block_ptr(addr,length);
     } else {
-        src_ptr     = get_block_ptr(addr);
+        src_ptr     = get_block_ptr(addr,length);
         dest_ptr    = trans.get_data_ptr();
     }
         
@@ -311,10 +679,95 @@ void dlsc_tlm_memory<DATATYPE>::b_transport(int id, tlm::tlm_generic_payload &tr
         }
     }
     
-    trans.set_dmi_allowed(true); // DMI is allowed to entire memory
+    trans.set_dmi_allowed(dmi_okay()); // DMI is allowed to entire memory (unless injecting errors)
     trans.set_response_status(tlm::TLM_OK_RESPONSE);
 }
 
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::dram_refresh(sc_core::sc_time &cmd_time) {
+    if(dram_cfg.t_refi == sc_core::SC_ZERO_TIME) return;
+
+    if(dram_next_refresh + dram_cfg.t_rfc + dram_cfg.t_refi <= cmd_time) {
+        // idle across several refresh intervals; skip to the last one
+        uint64_t n = static_cast<uint64_t>((cmd_time - dram_next_refresh) / dram_cfg.t_refi);
+        dram_refreshes      += n;
+        dram_next_refresh   += n * dram_cfg.t_refi;
+    }
+
+    while(dram_next_refresh <= cmd_time) {
+        // all banks are precharged and unavailable for the refresh
+        sc_core::sc_time refresh_end = dram_next_refresh + dram_cfg.t_rfc;
+        for(typename std::vector<dram_bank>::iterator it = dram_banks.begin(); it != dram_banks.end(); ++it) {
+            (*it).open = false;
+            if((*it).ready_time < refresh_end) {
+                (*it).ready_time = refresh_end;
+            }
+        }
+        dram_refreshes++;
+        dram_next_refresh += dram_cfg.t_refi;
+    }
+}
+
+template <typename DATATYPE>
+sc_core::sc_time dlsc_tlm_memory<DATATYPE>::dram_access(
+    const uint64_t addr,
+    const unsigned int length,
+    const bool write,
+    const sc_core::sc_time &req_time)
+{
+    const uint64_t row_index    = (addr & mem_mask) / dram_cfg.row_size;
+    dram_bank &bank             = dram_banks[row_index % dram_cfg.banks];
+    const uint64_t row          = row_index / dram_cfg.banks;
+
+    // command issue: once request arrives and bank is free (and past any refresh due by then)
+    sc_core::sc_time cmd_time   = req_time;
+    dram_refresh(cmd_time);
+    if(cmd_time < bank.ready_time) {
+        cmd_time = bank.ready_time;
+    }
+    dram_refresh(cmd_time);
+
+    sc_core::sc_time latency;
+    if(bank.open && bank.row == row) {
+        latency = dram_cfg.t_hit;
+        dram_hits++;
+    } else if(!bank.open) {
+        latency = dram_cfg.t_miss;
+        dram_misses++;
+    } else {
+        latency = dram_cfg.t_conflict;
+        dram_conflicts++;
+    }
+
+    // data transfer: after access latency, once data bus is free (turning it around if needed)
+    sc_core::sc_time bus_free   = next_time;
+    if(write != dram_last_write && bus_free > sc_core::SC_ZERO_TIME) {
+        bus_free += dram_cfg.t_turnaround;
+        dram_turnarounds++;
+    }
+
+    sc_core::sc_time data_start = cmd_time + latency;
+    if(data_start < bus_free) {
+        data_start = bus_free;
+    }
+
+    sc_core::sc_time data_end   = data_start + (length * byte_latency);
+
+    dlsc_verb("DRAM " << (write ? "write" : "read") << " 0x" << std::hex << addr << " (row 0x" << row << ") requested: " << req_time
+        << ", data: " << data_start << " - " << data_end);
+
+    // open-page policy: row stays open
+    bank.open           = true;
+    bank.row            = row;
+    bank.ready_time     = data_end;
+
+    next_time           = data_end;
+    dram_last_write     = write;
+    dram_bytes          += length;
+
+    return data_end;
+}
+
 template <typename DATATYPE>
 unsigned int dlsc_tlm_memory<DATATYPE>::transport_dbg(int id, tlm::tlm_generic_payload &trans) {
     if(!trans.is_read() && !trans.is_write()) {
@@ -335,9 +788,9 @@ unsigned int dlsc_tlm_memory<DATATYPE>::transport_dbg(int id, tlm::tlm_generic_p
 
     if(trans.is_write()) {
         src_ptr     = trans.get_data_ptr();
-        dest_ptr    = get_block_ptr(addr);
+        dest_ptr    = get_block_ptr(addr,length);
     } else {
-        src_ptr     = get_block_ptr(addr);
+        src_ptr     = get_block_ptr(addr,length);
         dest_ptr    = trans.get_data_ptr();
     }
     
@@ -348,41 +801,154 @@ unsigned int dlsc_tlm_memory<DATATYPE>::transport_dbg(int id, tlm::tlm_generic_p
 
 template <typename DATATYPE>
 bool dlsc_tlm_memory<DATATYPE>::get_direct_mem_ptr(int id, tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data) {
+    if(!dmi_okay()) {
+        dmi_data.set_start_address(0);
+        dmi_data.set_end_address((sc_dt::uint64)-1);
+        dmi_data.allow_none();
+        return false;
+    }
+
     // generate a DMI response that allows access to an entire block
+    // (memory is untimed, so DMI accesses are free)
 
     uint64_t addr   = trans.get_address() & ~block_mask;
 
     dmi_data.set_start_address(addr);
     dmi_data.set_end_address(addr+block_size-1);
-    dmi_data.set_dmi_ptr(get_block_ptr(addr));
+    dmi_data.set_dmi_ptr(get_block_ptr(addr,block_size));
     
     dmi_data.allow_read_write();
-    dmi_data.set_read_latency(byte_latency);
-    dmi_data.set_write_latency(byte_latency);
+    dmi_data.set_read_latency(sc_core::SC_ZERO_TIME);
+    dmi_data.set_write_latency(sc_core::SC_ZERO_TIME);
+
+    dmi_granted = true;
 
     return true;
 }
 
 template <typename DATATYPE>
-uint8_t *dlsc_tlm_memory<DATATYPE>::get_block_ptr(const uint64_t addr) {
-    // get pointer to local storage
-    uint8_t *block_ptr = blocks[addr & blocks_mask].get();
-    if(!block_ptr) {
-        dlsc_info("initializing block 0x" << std::hex << (addr & blocks_mask));
-        block_ptr = new uint8_t[block_size];
-        blocks[addr & blocks_mask] = boost::shared_array<uint8_t>(block_ptr);
-
-        // initialize memory block to address pattern
-        DATATYPE *init_ptr = reinterpret_cast<DATATYPE*>(block_ptr);
-        for(uint64_t i = (addr & blocks_mask) + base_addr ; i < (addr & blocks_mask) + base_addr + block_size ; i += sizeof(DATATYPE), ++init_ptr) {
-            *init_ptr = static_cast<DATATYPE>(i);
+void dlsc_tlm_memory<DATATYPE>::dmi_update() {
+    if(dmi_okay() || !dmi_granted) return;
+    // revoke any pointers handed out before error injection was enabled
+    dmi_granted = false;
+    for(unsigned int i=0;i<socket.size();++i) {
+        socket[i]->invalidate_direct_mem_ptr(0x0,(sc_dt::uint64)-1);
+    }
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_memory<DATATYPE>::mem_block *&dlsc_tlm_memory<DATATYPE>::get_block_slot(const uint64_t addr) {
+    const uint64_t index        = (addr & blocks_mask) >> block_bits;
+
+    mem_block **&table = tables[index >> table_bits];
+    if(!table) {
+        table = new mem_block*[1<<table_bits];
+        std::fill(table,table+(1<<table_bits),(mem_block*)NULL);
+    }
+
+    return table[index & ((1<<table_bits)-1)];
+}
+
+template <typename DATATYPE>
+typename dlsc_tlm_memory<DATATYPE>::mem_block *dlsc_tlm_memory<DATATYPE>::get_block(const uint64_t addr) {
+    const uint64_t block_addr   = addr & blocks_mask;
+
+    mem_block *&blk = get_block_slot(addr);
+    if(!blk) {
+        dlsc_info("initializing block 0x" << std::hex << block_addr);
+
+        // anonymous mapping; host only commits pages that are actually touched
+        void *ptr = mmap(NULL,block_size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+        if(ptr == MAP_FAILED) {
+            dlsc_error("failed to map block 0x" << std::hex << block_addr);
+            assert(false);
         }
+
+        blk = new mem_block;
+        blk->data = reinterpret_cast<uint8_t*>(ptr);
+        blk->page_init.resize(pages_per_block,false);
     }
 
-    // offset to beginning of accessed region
-    block_ptr += (addr & block_mask);
+    last_block_addr = block_addr;
+    last_block      = blk;
+
+    return blk;
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::init_pages(
+    mem_block *blk,
+    const uint64_t block_addr,
+    const uint64_t offset,
+    const uint64_t length)
+{
+    assert(length > 0 && offset + length <= block_size);
+
+    const unsigned int first    = offset / page_size;
+    const unsigned int last     = (offset + length - 1) / page_size;
+
+    for(unsigned int p=first;p<=last;++p) {
+        if(blk->page_init[p]) continue;
 
-    return block_ptr;
+        init_pattern(blk->data + p*page_size,block_addr + p*page_size,page_size);
+
+        blk->page_init[p] = true;
+        blk->pages_init++;
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::init_pattern(uint8_t *ptr, uint64_t addr, const uint64_t length) {
+    // initialize to address pattern
+    DATATYPE *init_ptr = reinterpret_cast<DATATYPE*>(ptr);
+    uint64_t i = (addr & mem_mask) + base_addr;
+    for(const uint64_t i_end = i + length ; i < i_end ; i += sizeof(DATATYPE), ++init_ptr) {
+        *init_ptr = static_cast<DATATYPE>(i);
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::load_region(const int fd, const uint8_t *src, uint64_t file_offset, uint64_t addr, uint64_t length) {
+    const uint64_t host_page = sysconf(_SC_PAGESIZE);
+
+    while(length) {
+        const uint64_t offset   = addr & block_mask;
+        const uint64_t lim      = std::min(block_size - offset,length);
+
+        mem_block *&blk = get_block_slot(addr);
+        bool mapped = false;
+
+        if(!blk && lim == block_size && (file_offset % host_page) == 0) {
+            // whole untouched block; map it straight from the file (private, so the image isn't modified)
+            void *ptr = mmap(NULL,block_size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_NORESERVE,fd,file_offset);
+            if(ptr != MAP_FAILED) {
+                blk = new mem_block;
+                blk->data = reinterpret_cast<uint8_t*>(ptr);
+                blk->page_init.resize(pages_per_block,true);
+                blk->pages_init = pages_per_block;
+                mapped = true;
+            }
+        }
+
+        if(!mapped) {
+            std::copy(src+file_offset,src+file_offset+lim,get_block_ptr(addr,lim));
+        }
+
+        addr        += lim;
+        file_offset += lim;
+        length      -= lim;
+    }
+}
+
+template <typename DATATYPE>
+void dlsc_tlm_memory<DATATYPE>::fill_region(uint64_t addr, uint64_t length) {
+    while(length) {
+        const uint64_t lim = std::min(block_size - (addr & block_mask),length);
+        uint8_t *ptr = get_block_ptr(addr,lim);
+        std::fill(ptr,ptr+lim,0);
+        addr    += lim;
+        length  -= lim;
+    }
 }
 
 #endif
@@ -5,11 +5,11 @@
 #include <vector>
 #include <deque>
 #include <algorithm>
+#include <string>
+#include <fstream>
 
 #include "dlsc_tlm_initiator_nb.h"
-
-//#include <boost/random/uniform_int.hpp>
-//#include <boost/random/variate_generator.hpp>
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t>
 class dlsc_tlm_memtest : public sc_core::sc_module {
@@ -33,6 +33,17 @@ public:
     void set_strobe_rate(const unsigned int strb_pct) { assert(strb_pct <= 100); this->strb_pct = strb_pct; }
     void set_strobe_all(const bool all) { strb_all = all; }
     void set_max_outstanding(const unsigned int mot) { this->max_mots = mot; }
+
+    // benchmark controls
+    void set_read_rate(const unsigned int read_pct) { assert(read_pct <= 100); this->read_pct = read_pct; }
+    // restrict burst lengths to [min,max]; (0,0) restores the default distribution
+    void set_burst_length(const unsigned int min, const unsigned int max) {
+        assert( (min == 0 && max == 0) || (min >= 1 && min <= max && max <= max_length) );
+        len_min = min; len_max = max; }
+    // results of each test are appended to these files (CSV: one row per socket; JSON: one object per line)
+    void set_label(const std::string &label) { this->label = label; }
+    void set_results_csv(const std::string &filename) { csv_file = filename; }
+    void set_results_json(const std::string &filename) { json_file = filename; }
     
     void end_of_elaboration();
 
@@ -56,17 +67,29 @@ private:
     std::vector<unsigned int> bytes_written;
     std::vector<unsigned int> bytes_read;
     std::vector<unsigned int> errors;
+    std::vector<std::vector<double> > latencies; // per-socket transaction latencies (ns)
+
+    struct latency_summary {
+        double min, p50, p99, max;
+    };
 
     // parameters
     uint64_t            base_addr;      // beginning of region-under-test
     unsigned int        size;           // size of region-under-test
     unsigned int        iterations;     // transactions to run per test
     const unsigned int  max_length;     // max burst length
+    dlsc_random_stream  rng;
     unsigned int        max_mots;       // max multiple-outstanding-transactions
     bool                ignore_error_read;  // don't flag failed transactions as an error
     bool                ignore_error_write; // ""
     unsigned int        strb_pct;       // use write strobes
     bool                strb_all;       // make strobes be all-or-nothing
+    unsigned int        read_pct;       // chance of a transaction being a read
+    unsigned int        len_min;        // burst length range (0 for default distribution)
+    unsigned int        len_max;        // ""
+    std::string         label;          // benchmark results
+    std::string         csv_file;       // ""
+    std::string         json_file;      // ""
 
     // clears all allocated memory
     void clear();
@@ -89,6 +112,12 @@ private:
     // finishes a transaction and checks/updates results
     void complete(transaction ts);
 
+    // sorts samples and summarizes them
+    static latency_summary summarize(std::vector<double> &samples);
+
+    // appends results of the last test to csv_file/json_file
+    void write_results(const sc_core::sc_time &elapsed);
+
     // marks a region as in-use
     inline void open_region(
         unsigned int    index,
@@ -115,7 +144,8 @@ dlsc_tlm_memtest<DATATYPE>::dlsc_tlm_memtest(
 ) :
     sc_module(nm),
     socket("socket"),
-    max_length(max_length)
+    max_length(max_length),
+    rng(this->name())
 {
     initiator = new dlsc_tlm_initiator_nb<DATATYPE>("initiator",max_length);
         initiator->socket.bind(socket);
@@ -132,6 +162,9 @@ dlsc_tlm_memtest<DATATYPE>::dlsc_tlm_memtest(
     strb_pct            = 20;
     strb_all            = false;
     max_mots            = 4;
+    read_pct            = 50;
+    len_min             = 0;
+    len_max             = 0;
 
     done                = true;
 
@@ -208,6 +241,10 @@ void dlsc_tlm_memtest<DATATYPE>::test_thread() {
         std::fill(errors.begin(),errors.end(),0);
         std::fill(bytes_read.begin(),bytes_read.end(),0);
         std::fill(bytes_written.begin(),bytes_written.end(),0);
+        for(unsigned int i=0;i<latencies.size();++i) {
+            latencies[i].clear();
+            latencies[i].reserve(iterations/latencies.size()+1);
+        }
 
         for(unsigned int i=0;i<iterations;++i) {
             bool launched = false;
@@ -234,7 +271,7 @@ void dlsc_tlm_memtest<DATATYPE>::test_thread() {
 
                 // if couldn't launch, wait until something completes
                 if(!launched) {
-                    outstanding[rand()%outstanding.size()].front()->wait(delay);
+                    outstanding[rng.below(outstanding.size())].front()->wait(delay);
                 }
             } while(!launched);
 
@@ -266,6 +303,10 @@ void dlsc_tlm_memtest<DATATYPE>::test_thread() {
             total_bytes_written += bytes_written[i];
             double mbps = ( bytes_read[i] + bytes_written[i] + 0.0 ) / (elapsed.to_seconds()*1000000.0);
             dlsc_info("For socket #" << std::dec << i << ": read: " << bytes_read[i] << ", wrote: " << bytes_written[i] << ", throughput: " << mbps << " MB/s");
+            if(!latencies[i].empty()) {
+                latency_summary lat = summarize(latencies[i]);
+                dlsc_info("For socket #" << std::dec << i << ": latency min/p50/p99/max: " << lat.min << "/" << lat.p50 << "/" << lat.p99 << "/" << lat.max << " ns");
+            }
             if(errors[i] > 0) {
                 if(ignore_error_read || ignore_error_write) {
                     dlsc_info("Bytes errored: " << errors[i] << " (but ignored)");
@@ -278,6 +319,8 @@ void dlsc_tlm_memtest<DATATYPE>::test_thread() {
         double mbps = ( total_bytes_read + total_bytes_written + 0.0 ) / (elapsed.to_seconds()*1000000.0);
         dlsc_info("Combined:      read: " << total_bytes_read << ", wrote: " << total_bytes_written << ", throughput: " << mbps << " MB/s");
 
+        write_results(elapsed);
+
         done        = true;
         done_event.notify();
     }
@@ -297,6 +340,7 @@ void dlsc_tlm_memtest<DATATYPE>::clear() {
     bytes_read.clear();
     bytes_written.clear();
     outstanding.clear();
+    latencies.clear();
 
     mem_array       = 0;
     init_done       = 0;
@@ -324,6 +368,7 @@ void dlsc_tlm_memtest<DATATYPE>::init() {
     bytes_read.resize(initiator->get_socket_size());
     bytes_written.resize(initiator->get_socket_size());
     outstanding.resize(initiator->get_socket_size());
+    latencies.resize(initiator->get_socket_size());
 
     std::fill(errors.begin(),errors.end(),0);
     std::fill(bytes_read.begin(),bytes_read.end(),0);
@@ -340,7 +385,7 @@ bool dlsc_tlm_memtest<DATATYPE>::launch(int socket_id) {
     unsigned int index;
     unsigned int length;
 
-    bool read = rand() % 2; // TODO
+    bool read = rng.below(100) < read_pct;
 
     if(!find_region(index,length,read)) {
         read = false;
@@ -373,11 +418,9 @@ template <typename DATATYPE>
 void dlsc_tlm_memtest<DATATYPE>::launch_write(int socket_id, unsigned int index, unsigned int length, bool allow_strobes) {
     uint64_t addr = base_addr + index*sizeof(DATATYPE);
     open_region(index,length,write_pending);
-    for(unsigned int i=0;i<length;++i) {
-        data[i] = rand(); // TODO
-    }
+    rng.fill(data,length);
     initiator->set_socket(socket_id);
-    if(!allow_strobes || (rand()%100) >= (int)strb_pct) {
+    if(!allow_strobes || rng.below(100) >= strb_pct) {
         // data only
         outstanding[socket_id].push_back(initiator->nb_write(addr,data,data+length,delay));
     } else {
@@ -385,10 +428,10 @@ void dlsc_tlm_memtest<DATATYPE>::launch_write(int socket_id, unsigned int index,
         for(unsigned int i=0;i<length;++i) {
             if(strb_all) {
                 // strobes are all-or-nothing
-                strb[i] = (rand() % 2 ) ? 0 : ((1u<<sizeof(DATATYPE))-1u);
+                strb[i] = rng.below(2) ? 0 : ((1u<<sizeof(DATATYPE))-1u);
             } else {
                 // strobes can be anything
-                strb[i] = rand() & ((1<<sizeof(DATATYPE))-1);
+                strb[i] = rng.next_u32() & ((1<<sizeof(DATATYPE))-1);
             }
         }
         outstanding[socket_id].push_back(initiator->nb_write(addr,data,data+length,strb,strb+length,delay));
@@ -404,10 +447,15 @@ bool dlsc_tlm_memtest<DATATYPE>::find_region(
 {
     unsigned int burst_boundary = 4096/sizeof(DATATYPE);
 
-    // TODO: randomize better
-    unsigned int begin  = rand() % size;                        // [0,size)
-    unsigned int min    = (rand() % 2) ? 1 : (max_length/2)+1;  // 50% chance of not-small burst
-    unsigned int max    = (rand() % (max_length-min+1)) + min;  // [min,max_length]
+    unsigned int begin  = rng.below(size);                      // [0,size)
+    unsigned int min, max;
+    if(len_max) {
+        min = len_min;
+        max = rng.rand(len_min,len_max);                        // [len_min,len_max]
+    } else {
+        min = rng.below(2) ? 1 : (max_length/2)+1;              // 50% chance of not-small burst
+        max = rng.rand(min,max_length);                         // [min,max_length]
+    }
     assert(max >= 1 && max <= max_length);
 
     length  = 0;
@@ -448,6 +496,8 @@ void dlsc_tlm_memtest<DATATYPE>::complete(transaction ts) {
     unsigned int length = ts->size();
 
     assert( (index+length) <= size );
+
+    latencies[ts->get_socket_id()].push_back( (ts->get_done_time() - ts->get_start_time()).to_seconds() * 1000000000.0 );
     
     if(ts->is_write()) {
         close_region(index,length,write_pending);
@@ -502,6 +552,81 @@ void dlsc_tlm_memtest<DATATYPE>::complete(transaction ts) {
     }
 }
 
+// sorts samples and summarizes them
+template <typename DATATYPE>
+typename dlsc_tlm_memtest<DATATYPE>::latency_summary dlsc_tlm_memtest<DATATYPE>::summarize(std::vector<double> &samples) {
+    assert(!samples.empty());
+    std::sort(samples.begin(),samples.end());
+    unsigned int n = samples.size();
+    latency_summary lat;
+    lat.min = samples.front();
+    lat.p50 = samples[(n-1)*50/100];
+    lat.p99 = samples[(n-1)*99/100];
+    lat.max = samples.back();
+    return lat;
+}
+
+// appends results of the last test to csv_file/json_file
+template <typename DATATYPE>
+void dlsc_tlm_memtest<DATATYPE>::write_results(const sc_core::sc_time &elapsed) {
+    double elapsed_ns = elapsed.to_seconds() * 1000000000.0;
+
+    if(!csv_file.empty()) {
+        // only emit a header for a new file
+        bool empty;
+        {
+            std::ifstream in(csv_file.c_str());
+            empty = !in.good() || in.peek() == std::ifstream::traits_type::eof();
+        }
+        std::ofstream os(csv_file.c_str(),std::ios::out | std::ios::app);
+        if(!os.good()) {
+            dlsc_error("failed to open " << csv_file);
+        } else {
+            if(empty) {
+                os << "label,socket,read_pct,burst_min,burst_max,max_outstanding,iterations,elapsed_ns,"
+                   << "transactions,bytes_read,bytes_written,bytes_errored,mbps,lat_min_ns,lat_p50_ns,lat_p99_ns,lat_max_ns" << std::endl;
+            }
+            for(unsigned int i=0;i<latencies.size();++i) {
+                latency_summary lat = { 0, 0, 0, 0 };
+                if(!latencies[i].empty()) lat = summarize(latencies[i]);
+                double mbps = ( bytes_read[i] + bytes_written[i] + 0.0 ) / (elapsed.to_seconds()*1000000.0);
+                os << label << "," << i << "," << read_pct << "," << len_min << "," << len_max << "," << max_mots << ","
+                   << iterations << "," << elapsed_ns << "," << latencies[i].size() << ","
+                   << bytes_read[i] << "," << bytes_written[i] << "," << errors[i] << "," << mbps << ","
+                   << lat.min << "," << lat.p50 << "," << lat.p99 << "," << lat.max << std::endl;
+            }
+        }
+    }
+
+    if(!json_file.empty()) {
+        std::ofstream os(json_file.c_str(),std::ios::out | std::ios::app);
+        if(!os.good()) {
+            dlsc_error("failed to open " << json_file);
+        } else {
+            os << "{\"label\":\"";
+            for(std::string::const_iterator it = label.begin(); it != label.end(); ++it) {
+                if(*it == '"' || *it == '\\') os << '\\';
+                os << *it;
+            }
+            os << "\",\"read_pct\":" << read_pct << ",\"burst_min\":" << len_min << ",\"burst_max\":" << len_max
+               << ",\"max_outstanding\":" << max_mots << ",\"iterations\":" << iterations << ",\"elapsed_ns\":" << elapsed_ns
+               << ",\"sockets\":[";
+            for(unsigned int i=0;i<latencies.size();++i) {
+                latency_summary lat = { 0, 0, 0, 0 };
+                if(!latencies[i].empty()) lat = summarize(latencies[i]);
+                double mbps = ( bytes_read[i] + bytes_written[i] + 0.0 ) / (elapsed.to_seconds()*1000000.0);
+                if(i) os << ",";
+                os << "{\"socket\":" << i << ",\"transactions\":" << latencies[i].size()
+                   << ",\"bytes_read\":" << bytes_read[i] << ",\"bytes_written\":" << bytes_written[i]
+                   << ",\"bytes_errored\":" << errors[i] << ",\"mbps\":" << mbps
+                   << ",\"latency_ns\":{\"min\":" << lat.min << ",\"p50\":" << lat.p50
+                   << ",\"p99\":" << lat.p99 << ",\"max\":" << lat.max << "}}";
+            }
+            os << "]}" << std::endl;
+        }
+    }
+}
+
 // marks a region as in-use
 template <typename DATATYPE>
 void dlsc_tlm_memtest<DATATYPE>::open_region(
@@ -4,12 +4,26 @@
 
 #include "dlsc_common.h"
 
-dlsc_tlm_mm::dlsc_tlm_mm(const unsigned int pool_size, const unsigned int payload_size) : dsize(payload_size) {
+dlsc_tlm_mm::dlsc_tlm_mm(const unsigned int pool_size, const unsigned int payload_size, const unsigned int slab_size) : dsize(payload_size), ssize(slab_size) {
     outstanding = 0;
+    high_water  = 0;
+    capacity    = 0;
+    allocs      = 0;
     set_size(pool_size);
 }
 
 dlsc_tlm_mm::~dlsc_tlm_mm() {
+    if(ssize) {
+        // slab payloads are only released as whole slabs
+        std::vector<slab>::iterator it = slabs.begin();
+        while(it != slabs.end()) {
+            delete [] (*it).payloads;
+            delete [] (*it).buffer;
+            it++;
+        }
+        return;
+    }
+
     std::vector<tlm::tlm_generic_payload*>::iterator it = pool.begin();
 
     while(it != pool.end()) {
@@ -26,7 +40,15 @@ void dlsc_tlm_mm::set_size(const unsigned int pool_size) {
     assert(pool_size > 0);
 
     size = pool_size;
-    
+
+    if(ssize) {
+        // preallocate; slabs are never trimmed
+        while(capacity < size) {
+            grow();
+        }
+        return;
+    }
+
     while(pool.size() > size) {
         delete_trans(pool.back());
         pool.pop_back();
@@ -38,42 +60,80 @@ void dlsc_tlm_mm::free(tlm::tlm_generic_payload *trans) {
 
     trans->reset();
 
-    if(pool.size() >= size) {
+    if(!ssize && pool.size() >= size) {
         delete_trans(trans);
     } else {
         pool.push_back(trans);
     }
-    
+
     outstanding--;
 }
 
 void dlsc_tlm_mm::delete_trans(tlm::tlm_generic_payload *trans) {
+    assert(!ssize);
     if(dsize) {
         assert(trans->get_data_ptr() && trans->get_byte_enable_ptr());
-        delete trans->get_data_ptr();
-        delete trans->get_byte_enable_ptr();
+        delete [] trans->get_data_ptr();
+        delete [] trans->get_byte_enable_ptr();
     }
     delete trans;
+    capacity--;
 }
 
-tlm::tlm_generic_payload *dlsc_tlm_mm::alloc() {
-    tlm::tlm_generic_payload *trans;
+tlm::tlm_generic_payload *dlsc_tlm_mm::new_trans() {
+    tlm::tlm_generic_payload *trans = new tlm::tlm_generic_payload();
+    trans->set_mm(this);
 
-    if(!pool.empty()) {
-        trans = pool.back();
-        pool.pop_back();
-    } else {
-        trans = new tlm::tlm_generic_payload();
-        trans->set_mm(this);
+    if(dsize) {
+        uint8_t *ptr = new uint8_t[dsize];
+        trans->set_data_ptr(ptr);
+        ptr = new uint8_t[dsize];
+        trans->set_byte_enable_ptr(ptr);
+    }
+
+    capacity++;
+
+    return trans;
+}
+
+void dlsc_tlm_mm::grow() {
+    assert(ssize);
+
+    slab s;
+    s.payloads  = new tlm::tlm_generic_payload[ssize];
+    s.buffer    = dsize ? new uint8_t[2*dsize*ssize] : NULL;
+    slabs.push_back(s);
 
+    pool.reserve(pool.size() + ssize);
+
+    // push in reverse, so payloads are handed out in address order
+    for(int i=ssize-1;i>=0;--i) {
+        tlm::tlm_generic_payload *trans = &s.payloads[i];
+        trans->set_mm(this);
         if(dsize) {
-            uint8_t *ptr = new uint8_t[dsize];
-            trans->set_data_ptr(ptr);
-            ptr = new uint8_t[dsize];
-            trans->set_byte_enable_ptr(ptr);
+            trans->set_data_ptr(s.buffer + (2*i+0)*dsize);
+            trans->set_byte_enable_ptr(s.buffer + (2*i+1)*dsize);
+        }
+        pool.push_back(trans);
+    }
+
+    capacity += ssize;
+}
+
+tlm::tlm_generic_payload *dlsc_tlm_mm::alloc() {
+    tlm::tlm_generic_payload *trans;
+
+    if(pool.empty()) {
+        if(ssize) {
+            grow();
+        } else {
+            pool.push_back(new_trans());
         }
     }
 
+    trans = pool.back();
+    pool.pop_back();
+
     trans->set_command(tlm::TLM_IGNORE_COMMAND);
     trans->set_address(0);
 //  trans->set_data_ptr(NULL);
@@ -83,9 +143,26 @@ tlm::tlm_generic_payload *dlsc_tlm_mm::alloc() {
     trans->set_streaming_width(0);
     trans->set_dmi_allowed(false);
     trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-    
+
     outstanding++;
+    allocs++;
+
+    if(outstanding > high_water) {
+        high_water = outstanding;
+    }
 
     return trans;
 }
 
+void dlsc_tlm_mm::report(std::ostream &os) const {
+    os << std::dec << "payloads allocated: " << allocs << ", outstanding: " << outstanding << ", high-water: " << high_water << ", capacity: " << capacity;
+    if(ssize) {
+        os << " (" << slabs.size() << " slabs of " << ssize << ")";
+    }
+}
+
+std::ostream& operator << ( std::ostream &os, const dlsc_tlm_mm &mm ) {
+    mm.report(os);
+    return os;
+}
+
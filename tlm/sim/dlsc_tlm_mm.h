@@ -3,22 +3,51 @@
 #define DLSC_TLM_MM_H_INCLUDED
 
 #include <vector>
+#include <iostream>
+#include <stdint.h>
 #include <tlm.h>
 
 class dlsc_tlm_mm : public tlm::tlm_mm_interface {
 public:
-    explicit dlsc_tlm_mm(const unsigned int pool_size = 1, const unsigned int payload_size = 0);
+    // slab_size == 0 : payloads are allocated/deleted individually; at most pool_size are kept for reuse
+    // slab_size  > 0 : payloads (and their data/byte-enable buffers) are allocated slab_size at a time
+    //                  from contiguous chunks; pool_size payloads are preallocated; nothing is freed until
+    //                  the mm is destroyed
+    explicit dlsc_tlm_mm(const unsigned int pool_size = 1, const unsigned int payload_size = 0, const unsigned int slab_size = 0);
     ~dlsc_tlm_mm();
     void set_size(const unsigned int pool_size);
     tlm::tlm_generic_payload *alloc();
     void free(tlm::tlm_generic_payload*);
+
+    // statistics
+    inline unsigned int get_outstanding() const { return outstanding; }
+    inline unsigned int get_high_water() const { return high_water; }
+    inline unsigned int get_capacity() const { return capacity; }
+    inline uint64_t get_allocs() const { return allocs; }
+    void report(std::ostream &os) const;
+
 private:
+    struct slab {
+        tlm::tlm_generic_payload    *payloads;
+        uint8_t                     *buffer;    // data and byte-enable storage for all payloads in slab
+    };
+
     void delete_trans(tlm::tlm_generic_payload*);
+    tlm::tlm_generic_payload *new_trans();
+    void grow();
+
     std::vector<tlm::tlm_generic_payload*> pool;
+    std::vector<slab> slabs;
     unsigned int outstanding;
+    unsigned int high_water;
+    unsigned int capacity;      // payloads currently owned by mm (pooled + outstanding)
+    uint64_t allocs;
     unsigned int size;
     const unsigned int dsize;
+    const unsigned int ssize;
 };
 
+std::ostream& operator << ( std::ostream &os, const dlsc_tlm_mm &mm );
+
 #endif
 
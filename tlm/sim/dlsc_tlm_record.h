@@ -0,0 +1,39 @@
+
+#ifndef DLSC_TLM_RECORD_H_INCLUDED
+#define DLSC_TLM_RECORD_H_INCLUDED
+
+#include <stdint.h>
+
+// on-disk format written by dlsc_tlm_recorder and read by dlsc_tlm_analyze;
+// no SystemC dependency, so it can be shared with offline tools
+//
+// file layout: one header, followed by 'capacity' record slots used as a ring
+// (or a plain append-only array when capacity is 0); once more than 'capacity'
+// records have been written, the oldest live record is at slot (count % capacity)
+
+#define DLSC_TLM_RECORD_MAGIC   "DLSCTLMR"
+#define DLSC_TLM_RECORD_VERSION 1
+
+struct dlsc_tlm_record_header {
+    char        magic[8];       // DLSC_TLM_RECORD_MAGIC (not null-terminated)
+    uint32_t    version;        // DLSC_TLM_RECORD_VERSION
+    uint32_t    record_size;    // sizeof(dlsc_tlm_record)
+    uint64_t    capacity;       // ring size in records (0 for unbounded)
+    uint64_t    count;          // total records written (including overwritten ones)
+    uint64_t    time_res_fs;    // unit of begin/end, in femtoseconds
+    char        name[88];       // attach point (null-terminated; may be truncated)
+};
+
+struct dlsc_tlm_record {
+    uint64_t    begin;          // request accepted by attach point
+    uint64_t    end;            // response returned by attach point
+    uint64_t    addr;           // address as seen by attach point
+    uint32_t    length;         // bytes
+    int8_t      socket;         // initiator-side socket
+    int8_t      target;         // target-side socket (-1 if not applicable/unrouted)
+    uint8_t     command;        // tlm::tlm_command
+    int8_t      response;       // tlm::tlm_response_status
+};
+
+#endif
+
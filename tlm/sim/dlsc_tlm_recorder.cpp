@@ -0,0 +1,79 @@
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "dlsc_tlm_recorder.h"
+
+dlsc_tlm_recorder::dlsc_tlm_recorder(
+    const std::string &filename,
+    const uint64_t capacity,
+    const std::string &name
+) :
+    capacity(capacity)
+{
+    count   = 0;
+    buffer.reserve(4096);
+
+    std::memset(&header,0,sizeof(header));
+    std::memcpy(header.magic,DLSC_TLM_RECORD_MAGIC,sizeof(header.magic));
+    header.version      = DLSC_TLM_RECORD_VERSION;
+    header.record_size  = sizeof(dlsc_tlm_record);
+    header.capacity     = capacity;
+    header.count        = 0;
+    header.time_res_fs  = (uint64_t)(sc_core::sc_get_time_resolution().to_seconds() * 1e15 + 0.5);
+    std::strncpy(header.name,(name.empty() ? filename : name).c_str(),sizeof(header.name)-1);
+
+    fd = open(filename.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    if(fd < 0) {
+        std::cerr << "dlsc_tlm_recorder: failed to open " << filename << std::endl;
+        return;
+    }
+
+    flush();
+}
+
+dlsc_tlm_recorder::~dlsc_tlm_recorder() {
+    if(fd < 0) return;
+    flush();
+    close(fd);
+}
+
+void dlsc_tlm_recorder::flush() {
+    if(fd < 0) return;
+
+    bool okay = true;
+
+    if(!buffer.empty()) {
+        okay = write_records(&buffer[0],buffer.size());
+        buffer.clear();
+    }
+
+    header.count = count;
+    if(!okay || pwrite(fd,&header,sizeof(header),0) != (ssize_t)sizeof(header)) {
+        std::cerr << "dlsc_tlm_recorder: write failed; recording disabled" << std::endl;
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool dlsc_tlm_recorder::write_records(const dlsc_tlm_record *recs, uint64_t n) {
+    while(n > 0) {
+        // contiguous run up to the end of the ring
+        uint64_t slot   = capacity ? (count % capacity) : count;
+        uint64_t run    = capacity ? std::min(n,capacity-slot) : n;
+        size_t bytes    = run * sizeof(dlsc_tlm_record);
+        off_t offset    = sizeof(header) + slot * sizeof(dlsc_tlm_record);
+
+        if(pwrite(fd,recs,bytes,offset) != (ssize_t)bytes) {
+            return false;
+        }
+
+        recs    += run;
+        count   += run;
+        n       -= run;
+    }
+    return true;
+}
+
@@ -0,0 +1,91 @@
+
+#ifndef DLSC_TLM_RECORDER_H_INCLUDED
+#define DLSC_TLM_RECORDER_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <systemc>
+#include <tlm.h>
+
+#include "dlsc_tlm_record.h"
+
+// logs completed transactions to a compact binary ring file (see dlsc_tlm_record.h);
+// attach with set_recorder() on a fabric, channel or nb initiator. Records are
+// buffered in memory and written out a chunk at a time.
+class dlsc_tlm_recorder {
+public:
+    // capacity is the ring size in records (0 for unbounded)
+    dlsc_tlm_recorder(const std::string &filename, const uint64_t capacity = (1<<20), const std::string &name = "");
+    ~dlsc_tlm_recorder();
+
+    inline bool is_open() const { return fd >= 0; }
+
+    // logs a completed transaction
+    inline void record(
+        const sc_core::sc_time          &begin,
+        const sc_core::sc_time          &end,
+        const tlm::tlm_generic_payload  &trans,
+        const int                       socket,
+        const int                       target  = -1);
+    inline void record(
+        const sc_core::sc_time          &begin,
+        const sc_core::sc_time          &end,
+        const tlm::tlm_generic_payload  &trans,
+        const int                       socket,
+        const int                       target,
+        const uint64_t                  addr);
+
+    // writes buffered records and updates the header
+    void flush();
+
+    inline uint64_t get_count() const { return count; }
+
+private:
+    int                                 fd;
+    const uint64_t                      capacity;
+    uint64_t                            count;          // records written to file
+    std::vector<dlsc_tlm_record>        buffer;
+    dlsc_tlm_record_header              header;
+
+    bool write_records(const dlsc_tlm_record *recs, uint64_t n);
+};
+
+inline void dlsc_tlm_recorder::record(
+    const sc_core::sc_time          &begin,
+    const sc_core::sc_time          &end,
+    const tlm::tlm_generic_payload  &trans,
+    const int                       socket,
+    const int                       target)
+{
+    record(begin,end,trans,socket,target,trans.get_address());
+}
+
+inline void dlsc_tlm_recorder::record(
+    const sc_core::sc_time          &begin,
+    const sc_core::sc_time          &end,
+    const tlm::tlm_generic_payload  &trans,
+    const int                       socket,
+    const int                       target,
+    const uint64_t                  addr)
+{
+    if(fd < 0) return;
+
+    buffer.resize(buffer.size()+1);
+    dlsc_tlm_record &rec = buffer.back();
+    rec.begin       = begin.value();
+    rec.end         = end.value();
+    rec.addr        = addr;
+    rec.length      = trans.get_data_length();
+    rec.socket      = socket;
+    rec.target      = target;
+    rec.command     = trans.get_command();
+    rec.response    = trans.get_response_status();
+
+    if(buffer.size() == buffer.capacity()) {
+        flush();
+    }
+}
+
+#endif
+
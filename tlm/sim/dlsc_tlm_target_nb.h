@@ -41,11 +41,24 @@ public:
         void (MODULE::*cb)(transaction),
         const unsigned int max_length = 16);
   
+    // optional callbacks for debug and DMI access; the debug callback must not wait.
+    void set_debug_callback(unsigned int (MODULE::*cb)(tlm::tlm_generic_payload&)) { callback_debug = cb; }
+    void set_dmi_callback(bool (MODULE::*cb)(tlm::tlm_generic_payload&,tlm::tlm_dmi&)) { callback_dmi = cb; }
+
+    // otherwise, debug accesses can be forwarded (in zero time) to the TLM storage
+    // that the driven pins ultimately reach, e.g. the memory behind a DUT; any
+    // BFM built on this gets a backdoor with bfm->target->set_debug_target(mem->socket).
+    // DMI is only forwarded if 'dmi' is set, since it lets LT initiators bypass
+    // the pins entirely. Without either, transport_dbg transfers nothing and DMI
+    // is refused.
+    void set_debug_target(sc_core::sc_export<tlm::tlm_fw_transport_if<> > &target, const bool dmi = false) {
+        debug_target = &target; debug_dmi = dmi; }
+  
     // multi_passthrough_target_socket callbacks
     tlm::tlm_sync_enum nb_transport_fw(int id,tlm::tlm_generic_payload &trans, tlm::tlm_phase &phase, sc_core::sc_time &delay);
-//    void b_transport(int id,tlm::tlm_generic_payload &trans, sc_core::sc_time &delay);
-//    unsigned int transport_dbg(int id,tlm::tlm_generic_payload &trans);
-//    bool get_direct_mem_ptr(int id,tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data);
+    void b_transport(int id,tlm::tlm_generic_payload &trans, sc_core::sc_time &delay);
+    unsigned int transport_dbg(int id,tlm::tlm_generic_payload &trans);
+    bool get_direct_mem_ptr(int id,tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi_data);
     
     SC_HAS_PROCESS(dlsc_tlm_target_nb);
 
@@ -68,6 +81,12 @@ private:
     void (MODULE::*callback)(transaction);                          // invoked at: ts->ready_time == sc_time_stamp()
     void (MODULE::*callback_delay)(transaction,sc_core::sc_time);   // invoked at: ts->ready_time == sc_time_stamp() + delay
     bool (MODULE::*callback_validate)(tlm::tlm_generic_payload&);   // validates payload before transaction is issued
+    unsigned int (MODULE::*callback_debug)(tlm::tlm_generic_payload&);              // services transport_dbg
+    bool (MODULE::*callback_dmi)(tlm::tlm_generic_payload&,tlm::tlm_dmi&);          // services get_direct_mem_ptr
+
+    // backdoor for transport_dbg (and get_direct_mem_ptr, with debug_dmi)
+    sc_core::sc_export<tlm::tlm_fw_transport_if<> > *debug_target;
+    bool                        debug_dmi;
 
     bool validate_payload(tlm::tlm_generic_payload &trans);         // internal fallback validation function
 
@@ -88,6 +107,9 @@ private:
     // triggered by complete_event; will generate nb_transport_bw calls
     void complete_method();
 
+    // wakes b_transport callers when any blocking transaction completes
+    sc_core::sc_event           blocking_event;
+
     // tidies up
     void complete(transaction ts);
 
@@ -118,6 +140,8 @@ dlsc_tlm_target_nb<MODULE,DATATYPE>::dlsc_tlm_target_nb(
     callback_delay  = cb;
     
     callback_validate = 0;
+    callback_debug  = 0;
+    callback_dmi    = 0;
 
     construct_common();
 }
@@ -139,6 +163,8 @@ dlsc_tlm_target_nb<MODULE,DATATYPE>::dlsc_tlm_target_nb(
     callback_delay  = 0;
 
     callback_validate = 0;
+    callback_debug  = 0;
+    callback_dmi    = 0;
 
     construct_common();
 }
@@ -147,6 +173,8 @@ dlsc_tlm_target_nb<MODULE,DATATYPE>::dlsc_tlm_target_nb(
 template <typename MODULE, typename DATATYPE>
 void dlsc_tlm_target_nb<MODULE,DATATYPE>::construct_common() {
     complete_outstanding = false;
+    debug_target    = 0;
+    debug_dmi       = false;
 
     if(tann) {
         ready_queue     = 0; // not needed when using timing annotation
@@ -160,6 +188,9 @@ void dlsc_tlm_target_nb<MODULE,DATATYPE>::construct_common() {
         sensitive << complete_event;
     
     socket.register_nb_transport_fw(this,&dlsc_tlm_target_nb<MODULE,DATATYPE>::nb_transport_fw);
+    socket.register_b_transport(this,&dlsc_tlm_target_nb<MODULE,DATATYPE>::b_transport);
+    socket.register_transport_dbg(this,&dlsc_tlm_target_nb<MODULE,DATATYPE>::transport_dbg);
+    socket.register_get_direct_mem_ptr(this,&dlsc_tlm_target_nb<MODULE,DATATYPE>::get_direct_mem_ptr);
 }
 
 template <typename MODULE, typename DATATYPE>
@@ -219,6 +250,85 @@ tlm::tlm_sync_enum dlsc_tlm_target_nb<MODULE,DATATYPE>::nb_transport_fw(
     return tlm::TLM_ACCEPTED;
 }
 
+// b_transport callback; bridged onto the regular callback path, with the
+// calling thread waiting for the transaction to be completed
+template <typename MODULE, typename DATATYPE>
+void dlsc_tlm_target_nb<MODULE,DATATYPE>::b_transport(
+    int id,
+    tlm::tlm_generic_payload &trans,
+    sc_core::sc_time &delay)
+{
+    if(!validate_payload(trans)) {
+        // validation failed; response status already set
+        return;
+    }
+
+    transaction ts(new transaction_state(this,&trans,delay,id));
+    ts->blocking = true;
+    outstanding[&trans] = ts;
+
+    if(!tann && delay != sc_core::SC_ZERO_TIME) {
+        // callback expects to be invoked at ready_time
+        sc_core::wait(delay);
+        delay = sc_core::SC_ZERO_TIME;
+    }
+
+    sc_core::sc_time local_time = sc_core::sc_time_stamp() + delay;
+
+    ready_launch(ts,delay);
+
+    while(!ts->completed()) {
+        sc_core::wait(blocking_event);
+    }
+
+    // adjust delay for time spent sleeping, then for completion time
+    if(local_time > sc_core::sc_time_stamp()) {
+        delay = local_time - sc_core::sc_time_stamp();
+    } else {
+        delay = sc_core::SC_ZERO_TIME;
+    }
+    ts->calc_complete_delay(delay);
+
+    outstanding.erase(&trans);
+}
+
+// transport_dbg callback; completes in zero time (or not at all)
+template <typename MODULE, typename DATATYPE>
+unsigned int dlsc_tlm_target_nb<MODULE,DATATYPE>::transport_dbg(
+    int id,
+    tlm::tlm_generic_payload &trans)
+{
+    if(callback_debug) {
+        return (callback_module->*callback_debug)(trans);
+    }
+    if(debug_target) {
+        return (*debug_target)->transport_dbg(trans);
+    }
+    // no backdoor into whatever this target drives
+    return 0;
+}
+
+// get_direct_mem_ptr callback
+template <typename MODULE, typename DATATYPE>
+bool dlsc_tlm_target_nb<MODULE,DATATYPE>::get_direct_mem_ptr(
+    int id,
+    tlm::tlm_generic_payload &trans,
+    tlm::tlm_dmi &dmi_data)
+{
+    if(callback_dmi) {
+        return (callback_module->*callback_dmi)(trans,dmi_data);
+    }
+    if(debug_target && debug_dmi) {
+        return (*debug_target)->get_direct_mem_ptr(trans,dmi_data);
+    }
+
+    // refuse for the whole address space, so initiators don't keep asking
+    dmi_data.allow_none();
+    dmi_data.set_start_address(0);
+    dmi_data.set_end_address((sc_dt::uint64)-1);
+    return false;
+}
+
 // internal fallback validation function
 template <typename MODULE, typename DATATYPE>
 bool dlsc_tlm_target_nb<MODULE,DATATYPE>::validate_payload(tlm::tlm_generic_payload &trans) {
@@ -329,6 +439,11 @@ template <typename MODULE, typename DATATYPE>
 void dlsc_tlm_target_nb<MODULE,DATATYPE>::completed_notify(tlm::tlm_generic_payload *payload) {
     transaction ts = outstanding[payload];
     assert(ts);
+    if(ts->blocking) {
+        // b_transport caller responds on its own
+        blocking_event.notify();
+        return;
+    }
     complete_queue.push_back(ts);
     complete_event.notify();
 }
@@ -410,6 +525,9 @@ private:
 
     bool                                complete_flag;
 
+    bool                                blocking;           // issued via b_transport
+    bool                                acquired;           // payload has an mm (b_transport payloads needn't)
+
     const int                           socket_id;
 
     // invoked by public complete methods; notifies parent
@@ -513,15 +631,17 @@ dlsc_tlm_target_nb<MODULE,DATATYPE>::transaction_state::transaction_state(
     socket_id(socket_id)
 {
     assert(parent && payload);
-    payload->acquire();
+    acquired = payload->has_mm();
+    if(acquired) payload->acquire();
     complete_flag = false;
+    blocking = false;
     ready_time = sc_core::sc_time_stamp() + ready_delay;
 }
 
 // destructor
 template <typename MODULE, typename DATATYPE>
 dlsc_tlm_target_nb<MODULE,DATATYPE>::transaction_state::~transaction_state() {
-    payload->release();
+    if(acquired) payload->release();
 }
 
 #endif
@@ -0,0 +1,304 @@
+
+// offline analyzer for transaction logs written by dlsc_tlm_recorder
+//
+// build:
+//   make -f dlsc_tlm_analyze.makefile   (or 'make tools' from the top level)
+//
+// usage:
+//   dlsc_tlm_analyze [--bin <ns>] [--csv] <file> [<file> ...]
+//
+// for each file, reports:
+//   - bandwidth vs. time (bytes completed per bin; read/write)
+//   - queue depth vs. time (time-weighted average and peak outstanding per bin)
+//   - latency distribution (overall and per socket; percentiles and a log2 histogram)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+
+#include "dlsc_tlm_record.h"
+
+// tlm::tlm_command
+enum { CMD_READ = 0, CMD_WRITE = 1 };
+// tlm::tlm_response_status
+enum { RESP_OK = 1 };
+
+struct trace {
+    std::string                     filename;
+    dlsc_tlm_record_header          header;
+    std::vector<dlsc_tlm_record>    records;    // oldest first
+    double                          ns_per_unit;
+};
+
+static bool load(const char *filename, trace &tr) {
+    FILE *f = fopen(filename,"rb");
+    if(!f) {
+        fprintf(stderr,"%s: can't open\n",filename);
+        return false;
+    }
+
+    tr.filename = filename;
+
+    if(fread(&tr.header,sizeof(tr.header),1,f) != 1 ||
+        memcmp(tr.header.magic,DLSC_TLM_RECORD_MAGIC,sizeof(tr.header.magic)) != 0)
+    {
+        fprintf(stderr,"%s: not a transaction log\n",filename);
+        fclose(f);
+        return false;
+    }
+    if(tr.header.version != DLSC_TLM_RECORD_VERSION || tr.header.record_size != sizeof(dlsc_tlm_record)) {
+        fprintf(stderr,"%s: unsupported version %u (record size %u)\n",filename,tr.header.version,tr.header.record_size);
+        fclose(f);
+        return false;
+    }
+    tr.header.name[sizeof(tr.header.name)-1] = '\0';
+    tr.ns_per_unit = tr.header.time_res_fs / 1000000.0;
+
+    const uint64_t cap      = tr.header.capacity;
+    const uint64_t count    = tr.header.count;
+    const uint64_t live     = (cap && count > cap) ? cap : count;
+    const uint64_t first    = (cap && count > cap) ? (count % cap) : 0;
+
+    tr.records.resize(live);
+    if(live) {
+        // [first,live) then [0,first)
+        bool okay = true;
+        fseek(f,sizeof(tr.header) + first*sizeof(dlsc_tlm_record),SEEK_SET);
+        okay &= fread(&tr.records[0],sizeof(dlsc_tlm_record),live-first,f) == (live-first);
+        if(first) {
+            fseek(f,sizeof(tr.header),SEEK_SET);
+            okay &= fread(&tr.records[live-first],sizeof(dlsc_tlm_record),first,f) == first;
+        }
+        if(!okay) {
+            fprintf(stderr,"%s: truncated\n",filename);
+            fclose(f);
+            return false;
+        }
+    }
+
+    fclose(f);
+    return true;
+}
+
+static bool by_begin(const dlsc_tlm_record &a, const dlsc_tlm_record &b) {
+    return a.begin < b.begin;
+}
+
+static double percentile(const std::vector<double> &sorted, unsigned int pct) {
+    return sorted[((sorted.size()-1)*pct)/100];
+}
+
+static void latency_report(const char *label, std::vector<double> &lat, bool csv) {
+    if(lat.empty()) return;
+    std::sort(lat.begin(),lat.end());
+
+    if(csv) {
+        printf("latency,%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n",label,(unsigned int)lat.size(),
+            lat.front(),percentile(lat,50),percentile(lat,90),percentile(lat,99),lat.back());
+        return;
+    }
+
+    printf("  %-10s n: %-8u min: %-10.3f p50: %-10.3f p90: %-10.3f p99: %-10.3f max: %-10.3f (ns)\n",label,(unsigned int)lat.size(),
+        lat.front(),percentile(lat,50),percentile(lat,90),percentile(lat,99),lat.back());
+}
+
+static void latency_histogram(const std::vector<double> &lat, bool csv) {
+    // log2 buckets: [0,1) [1,2) [2,4) [4,8) ... ns
+    std::vector<unsigned int> buckets;
+    for(unsigned int i=0;i<lat.size();++i) {
+        unsigned int b = 0;
+        double v = lat[i];
+        while(v >= 1.0) { v /= 2.0; ++b; }
+        if(b >= buckets.size()) buckets.resize(b+1,0);
+        buckets[b]++;
+    }
+
+    unsigned int peak = 0, first = buckets.size();
+    for(unsigned int b=0;b<buckets.size();++b) {
+        peak = std::max(peak,buckets[b]);
+        if(buckets[b] && b < first) first = b;
+    }
+
+    for(unsigned int b=first;b<buckets.size();++b) {
+        double lo = b ? (double)(1ull<<(b-1)) : 0.0;
+        double hi = (double)(1ull<<b);
+        if(csv) {
+            printf("histogram,%.0f,%.0f,%u\n",lo,hi,buckets[b]);
+        } else {
+            unsigned int bar = peak ? (buckets[b]*50u)/peak : 0;
+            printf("  [%10.0f,%10.0f) %8u %s\n",lo,hi,buckets[b],std::string(bar,'#').c_str());
+        }
+    }
+}
+
+static void analyze(trace &tr, double bin_ns, bool csv) {
+    std::vector<dlsc_tlm_record> &recs = tr.records;
+    const double npu = tr.ns_per_unit;
+
+    if(csv) {
+        printf("file,%s,%s\n",tr.filename.c_str(),tr.header.name);
+    } else {
+        printf("== %s (%s)\n",tr.filename.c_str(),tr.header.name);
+        printf("  records: %llu logged, %llu retained",(unsigned long long)tr.header.count,(unsigned long long)recs.size());
+        if(tr.header.count > recs.size()) printf(" (ring wrapped; oldest %llu dropped)",(unsigned long long)(tr.header.count - recs.size()));
+        printf("\n");
+    }
+
+    if(recs.empty()) return;
+
+    std::sort(recs.begin(),recs.end(),by_begin);
+
+    uint64_t t_begin = recs.front().begin;
+    uint64_t t_end   = 0;
+    uint64_t bytes_rd = 0, bytes_wr = 0, errors = 0;
+    for(unsigned int i=0;i<recs.size();++i) {
+        t_end = std::max(t_end,recs[i].end);
+        if(recs[i].command == CMD_READ) bytes_rd += recs[i].length;
+        if(recs[i].command == CMD_WRITE) bytes_wr += recs[i].length;
+        if(recs[i].response != RESP_OK) errors++;
+    }
+
+    const double span_ns = (t_end - t_begin) * npu;
+    if(bin_ns <= 0.0) {
+        bin_ns = span_ns > 0.0 ? span_ns / 50.0 : 1.0;
+    }
+    const unsigned int bins = (unsigned int)(span_ns / bin_ns) + 1;
+
+    if(!csv) {
+        printf("  span: %.3f ns, read: %llu bytes, written: %llu bytes, errors: %llu, average: %.3f MB/s\n",
+            span_ns,(unsigned long long)bytes_rd,(unsigned long long)bytes_wr,(unsigned long long)errors,
+            span_ns > 0.0 ? (bytes_rd+bytes_wr)*1000.0/span_ns : 0.0);
+    }
+
+    // ** bandwidth and queue depth vs. time **
+
+    std::vector<double> bw_rd(bins,0.0), bw_wr(bins,0.0);
+    std::vector<double> depth_area(bins,0.0);
+    std::vector<unsigned int> depth_peak(bins,0);
+
+    // completed bytes are attributed to the bin of their completion
+    for(unsigned int i=0;i<recs.size();++i) {
+        unsigned int b = (unsigned int)(((recs[i].end - t_begin) * npu) / bin_ns);
+        if(b >= bins) b = bins-1;
+        if(recs[i].command == CMD_READ) bw_rd[b] += recs[i].length;
+        if(recs[i].command == CMD_WRITE) bw_wr[b] += recs[i].length;
+    }
+
+    // outstanding count steps up at begin and down at end
+    std::vector<std::pair<uint64_t,int> > steps;
+    steps.reserve(recs.size()*2);
+    for(unsigned int i=0;i<recs.size();++i) {
+        steps.push_back(std::make_pair(recs[i].begin,+1));
+        steps.push_back(std::make_pair(recs[i].end,-1));
+    }
+    std::sort(steps.begin(),steps.end());   // ends sort before begins at the same time
+
+    int depth = 0;
+    unsigned int peak = 0;
+    for(unsigned int i=0;i<steps.size();++i) {
+        depth += steps[i].second;
+        if(i+1 == steps.size()) break;
+        double t0 = (steps[i].first - t_begin) * npu;
+        double t1 = (steps[i+1].first - t_begin) * npu;
+        peak = std::max(peak,(unsigned int)depth);
+        // spread this interval's area over the bins it covers
+        while(t0 < t1) {
+            unsigned int b = (unsigned int)(t0 / bin_ns);
+            if(b >= bins) b = bins-1;
+            double bin_end = std::min(t1,(b+1)*bin_ns);
+            if(bin_end <= t0) bin_end = t1;
+            depth_area[b] += depth * (bin_end - t0);
+            depth_peak[b] = std::max(depth_peak[b],(unsigned int)depth);
+            t0 = bin_end;
+        }
+    }
+
+    if(csv) {
+        printf("bin,start_ns,read_mbps,write_mbps,avg_depth,peak_depth\n");
+    } else {
+        printf("  bandwidth/queue depth (bin: %.3f ns, peak depth: %u)\n",bin_ns,peak);
+        printf("  %14s %12s %12s %10s %6s\n","start (ns)","read MB/s","write MB/s","avg depth","peak");
+    }
+    for(unsigned int b=0;b<bins;++b) {
+        double rd = bw_rd[b]*1000.0/bin_ns;
+        double wr = bw_wr[b]*1000.0/bin_ns;
+        double avg = depth_area[b]/bin_ns;
+        if(csv) {
+            printf("bin,%.3f,%.3f,%.3f,%.3f,%u\n",b*bin_ns,rd,wr,avg,depth_peak[b]);
+        } else {
+            printf("  %14.3f %12.3f %12.3f %10.3f %6u\n",b*bin_ns,rd,wr,avg,depth_peak[b]);
+        }
+    }
+
+    // ** latency **
+
+    std::vector<double> lat_all;
+    std::map<int,std::vector<double> > lat_socket;
+    lat_all.reserve(recs.size());
+    for(unsigned int i=0;i<recs.size();++i) {
+        double l = (recs[i].end - recs[i].begin) * npu;
+        lat_all.push_back(l);
+        lat_socket[recs[i].socket].push_back(l);
+    }
+
+    if(csv) {
+        printf("latency,socket,n,min_ns,p50_ns,p90_ns,p99_ns,max_ns\n");
+    } else {
+        printf("  latency\n");
+    }
+    latency_report("all",lat_all,csv);
+    for(std::map<int,std::vector<double> >::iterator it = lat_socket.begin(); it != lat_socket.end(); ++it) {
+        char label[32];
+        snprintf(label,sizeof(label),csv ? "%d" : "socket %d",it->first);
+        latency_report(label,it->second,csv);
+    }
+
+    if(csv) {
+        printf("histogram,lo_ns,hi_ns,count\n");
+    } else {
+        printf("  latency histogram (ns)\n");
+    }
+    latency_histogram(lat_all,csv);
+}
+
+int main(int argc, char *argv[]) {
+    double bin_ns = 0.0;
+    bool csv = false;
+    std::vector<const char*> files;
+
+    for(int i=1;i<argc;++i) {
+        if(!strcmp(argv[i],"--bin") && i+1 < argc) {
+            bin_ns = atof(argv[++i]);
+        } else if(!strcmp(argv[i],"--csv")) {
+            csv = true;
+        } else if(argv[i][0] == '-') {
+            fprintf(stderr,"usage: %s [--bin <ns>] [--csv] <file> [<file> ...]\n",argv[0]);
+            return 1;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if(files.empty()) {
+        fprintf(stderr,"usage: %s [--bin <ns>] [--csv] <file> [<file> ...]\n",argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for(unsigned int i=0;i<files.size();++i) {
+        trace tr;
+        if(!load(files[i],tr)) {
+            result = 1;
+            continue;
+        }
+        analyze(tr,bin_ns,csv);
+    }
+
+    return result;
+}
+
@@ -10,6 +10,7 @@
 #include "dlsc_tlm_target_nb.h"
 #include "dlsc_wishbone_types.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_wishbone_tlm_master_template : public sc_core::sc_module {
@@ -55,6 +56,7 @@ private:
     bool                        pipelined;
     bool                        registered;
     int                         cmd_pct;
+    dlsc_random_stream          rng;
 
     std::deque<cmd_data>        cmd_data_queue;
 
@@ -86,7 +88,8 @@ dlsc_wishbone_tlm_master_template<DATATYPE,ADDRTYPE>::dlsc_wishbone_tlm_master_t
     wb_ack_i("wb_ack_i"),
     wb_err_i("wb_err_i"),
     wb_dat_i("wb_dat_i"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     target = new dlsc_tlm_target_nb<dlsc_wishbone_tlm_master_template,DATATYPE>(
         "target", this, &dlsc_wishbone_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback);
@@ -142,6 +145,8 @@ void dlsc_wishbone_tlm_master_template<DATATYPE,ADDRTYPE>::target_callback(trans
     
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_wishbone_tlm_master_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         rst_method();
     } else {
@@ -177,7 +182,7 @@ template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_wishbone_tlm_master_template<DATATYPE,ADDRTYPE>::cmd_method() {
 
     if(!wb_stb_o || (pipelined ? !wb_stall_i : wb_ack_i) ) {        
-        if( !cmd_data_queue.empty() && (rand()%100) < cmd_pct ) {
+        if( !cmd_data_queue.empty() && (int)rng.below(100) < cmd_pct ) {
             // drive new command
             cmd_data cmd = cmd_data_queue.front(); cmd_data_queue.pop_front();
 
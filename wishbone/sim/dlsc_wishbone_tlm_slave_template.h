@@ -10,6 +10,7 @@
 #include "dlsc_tlm_initiator_nb.h"
 #include "dlsc_wishbone_types.h"
 #include "dlsc_common.h"
+#include "dlsc_random.h"
 
 template <typename DATATYPE = uint32_t, typename ADDRTYPE = uint32_t>
 class dlsc_wishbone_tlm_slave_template : public sc_core::sc_module {
@@ -52,6 +53,7 @@ private:
     int                         max_outstanding;
     int                         cmd_pct;
     int                         resp_pct;
+    dlsc_random_stream          rng;
 
     std::deque<transaction>     resp_queue;
     std::deque<DATATYPE>        data_queue;
@@ -94,7 +96,8 @@ dlsc_wishbone_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_wishbone_tlm_slave_tem
     wb_ack_o("wb_ack_o"),
     wb_err_o("wb_err_o"),
     wb_dat_o("wb_dat_o"),
-    socket("socket")
+    socket("socket"),
+    rng(this->name())
 {
     initiator = new dlsc_tlm_initiator_nb<DATATYPE>("initiator");
         initiator->socket.bind(socket);
@@ -121,6 +124,8 @@ dlsc_wishbone_tlm_slave_template<DATATYPE,ADDRTYPE>::dlsc_wishbone_tlm_slave_tem
     
 template <typename DATATYPE, typename ADDRTYPE>
 void dlsc_wishbone_tlm_slave_template<DATATYPE,ADDRTYPE>::clk_method() {
+    dlsc_prof_process();
+
     if(rst) {
         rst_method();
     } else {
@@ -266,7 +271,7 @@ void dlsc_wishbone_tlm_slave_template<DATATYPE,ADDRTYPE>::resp_method() {
 
         if(!data_queue.empty()) {
 
-            if( (rand()%100) <= resp_pct ) {
+            if( (int)rng.below(100) <= resp_pct ) {
                 wb_ack_o        = 1;
                 wb_dat_o        = data_queue.front(); data_queue.pop_front();
                 --outstanding;
@@ -293,7 +298,7 @@ void dlsc_wishbone_tlm_slave_template<DATATYPE,ADDRTYPE>::stall_method() {
         return;
     }
 
-    wb_stall_o      = ( outstanding >= max_outstanding || (rand()%100) > cmd_pct ) ? 1 : 0;
+    wb_stall_o      = ( outstanding >= max_outstanding || (int)rng.below(100) > cmd_pct ) ? 1 : 0;
 
 }
 